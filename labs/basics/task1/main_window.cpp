@@ -1,28 +1,55 @@
 // NOLINTBEGIN(cppcoreguidelines-owning-memory)
 #include "main_window.h"
 
+#include "ticket_csv.h"
+#include "ticket_list_model.h"
+
 #include <QApplication>
 #include <QComboBox>
+#include <QFile>
+#include <QFileDialog>
 #include <QGroupBox>
 #include <QHBoxLayout>
+#include <QItemSelectionModel>
 #include <QLabel>
 #include <QLineEdit>
+#include <QListView>
 #include <QListWidget>
+#include <QMenuBar>
+#include <QMessageBox>
 #include <QProgressBar>
 #include <QPushButton>
 #include <QRandomGenerator>
+#include <QSignalBlocker>
 #include <QSpinBox>
+#include <QStandardPaths>
 #include <QStyleHints>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <cmath>
-#include <ranges>
 
-MainWindow::MainWindow() {  // NOLINT
+namespace {
+constexpr qsizetype kHistoryDepth = 256;
+constexpr qsizetype kSearchResultLimit = 50;
+}  // namespace
+
+MainWindow::MainWindow()  // NOLINT
+    : archive_(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation))
+    , history_(kHistoryDepth) {
+    const bool loaded = archive_.Load(&tickets_);
     SetupUI();
+    RefreshAfterReload();
+    if (!loaded) {
+        QMessageBox::warning(
+            this, "Архив",
+            "Не удалось загрузить сохранённые билеты. Файлы оставлены без изменений, "
+            "изменения в этом сеансе не будут сохранены.");
+    }
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow() {
+    archive_.Compact(tickets_);
+}
 
 void MainWindow::SetupUI() {
     // TOP LAYOUT (progress bars)
@@ -46,9 +73,21 @@ void MainWindow::SetupUI() {
     auto* up_layout = new QVBoxLayout(view);
     count_spin_box_ = new QSpinBox(view);
     count_spin_box_->setMaximumWidth(200);
-    ticket_list_ = new QListWidget(view);
+    count_spin_box_->setRange(0, static_cast<int>(kMaxTicketCount));
+    search_edit_ = new QLineEdit(view);
+    search_edit_->setPlaceholderText("Поиск по названию и подсказке");
+    search_edit_->setClearButtonEnabled(true);
+    search_results_ = new QListWidget(view);
+    search_results_->setMaximumHeight(150);
+    search_results_->hide();
+    ticket_list_ = new QListView(view);
+    ticket_list_->setUniformItemSizes(true);
+    ticket_model_ = new TicketListModel(&tickets_, ticket_list_);
+    ticket_list_->setModel(ticket_model_);
     up_layout->addWidget(count_spin_box_);
     up_layout->setAlignment(count_spin_box_, Qt::AlignLeft);
+    up_layout->addWidget(search_edit_);
+    up_layout->addWidget(search_results_);
     up_layout->addWidget(ticket_list_);
 
     // DOWN LAYOUT (question_view)
@@ -81,8 +120,10 @@ void MainWindow::SetupUI() {
     auto* bottom_widget = new QWidget(this);
     auto* bottom_layout = new QHBoxLayout(bottom_widget);
     previous_button_ = new QPushButton("Предыдущий");
+    forward_button_ = new QPushButton("Вперёд");
     next_button_ = new QPushButton("Следующий");
     bottom_layout->addWidget(previous_button_);
+    bottom_layout->addWidget(forward_button_);
     bottom_layout->addWidget(next_button_);
 
     // MAIN LAYOUT
@@ -94,31 +135,39 @@ void MainWindow::SetupUI() {
     main_layout->addWidget(bottom_widget);
     central_widget->setLayout(main_layout);
 
+    // MENU
+    auto* file_menu = menuBar()->addMenu("Файл");
+    file_menu->addAction("Импорт CSV...", this, &MainWindow::OnImportTriggered);
+    file_menu->addAction("Экспорт CSV...", this, &MainWindow::OnExportTriggered);
+
     // CONNECTIONS
     connect(count_spin_box_, &QSpinBox::valueChanged, this, &MainWindow::OnCountChanged);
     connect(
-        ticket_list_, &QListWidget::itemSelectionChanged, this,
+        ticket_list_->selectionModel(), &QItemSelectionModel::selectionChanged, this,
         &MainWindow::OnItemSelectionChanged);
-    connect(ticket_list_, &QListWidget::itemDoubleClicked, this, &MainWindow::OnItemDoubleClicked);
+    connect(ticket_list_, &QListView::doubleClicked, this, &MainWindow::OnItemDoubleClicked);
     connect(name_edit_, &QLineEdit::returnPressed, this, &MainWindow::OnNameEditChanged);
     connect(status_combo_box_, &QComboBox::currentIndexChanged, this, &MainWindow::OnStatusChanged);
     connect(next_button_, &QPushButton::clicked, this, &MainWindow::OnNextClicked);
     connect(previous_button_, &QPushButton::clicked, this, &MainWindow::OnPreviousClicked);
+    connect(forward_button_, &QPushButton::clicked, this, &MainWindow::OnForwardClicked);
+    connect(ticket_model_, &TicketListModel::TicketsChanged, this, &MainWindow::UpdateProgress);
     connect(hint_edit_, &QLineEdit::returnPressed, this, &MainWindow::OnHintEditChanged);
+    connect(search_edit_, &QLineEdit::textChanged, this, &MainWindow::OnSearchTextChanged);
+    connect(
+        search_results_, &QListWidget::itemClicked, this, &MainWindow::OnSearchResultClicked);
 }
 
 void MainWindow::OnCountChanged(int count) {
-    tickets_.clear();
-    for (size_t i : std::ranges::iota_view(0, count)) {
-        Ticket ticket(i, QString("Билет %1").arg(i + 1), TicketStatus::Default, "");
-        tickets_.append(ticket);
+    for (qsizetype i = count, size = tickets_.Size(); i < size; ++i) {
+        search_index_.Remove(tickets_, i);
+    }
+    ticket_model_->Resize(count);
+    archive_.RecordResize(count);
+    history_.Truncate(count);
+    if (current_index_ >= count) {
+        current_index_ = -1;
     }
-    history_.clear();
-    completed_ = 0;
-    partial_ = 0;
-    current_index_ = -1;
-    is_programmatic_selection_ = false;
-    UpdateTicketList();
     UpdateQuestionView();
     UpdateProgress();
 }
@@ -127,103 +176,156 @@ void MainWindow::OnItemSelectionChanged() {
     if (is_programmatic_selection_) {
         return;
     }
-    QList<QListWidgetItem*> selected_items = ticket_list_->selectedItems();
+    QModelIndexList selected_items = ticket_list_->selectionModel()->selectedIndexes();
     if (selected_items.isEmpty()) {
         current_index_ = -1;
         return;
     }
-    history_.append(current_index_);
-    current_index_ = selected_items.first()->data(Qt::UserRole).toInt();
+    int index = selected_items.first().row();
+    history_.Visit(current_index_, index);
+    current_index_ = index;
+    tickets_.MarkReviewed(index);
     UpdateQuestionView();
 }
 
-void MainWindow::OnItemDoubleClicked(QListWidgetItem* item) {
-    int index = item->data(Qt::UserRole).toInt();
-    Ticket& ticket = tickets_[index];
-    auto [_, name, status, hint] = ticket.GetPrivate();
-    TicketStatus new_status = TicketStatus::Default;
-    if (status == TicketStatus::Green) {
-        new_status = TicketStatus::Yellow;
-        partial_++;
-        completed_--;
-    } else {
-        new_status = TicketStatus::Green;
-        if (status == TicketStatus::Yellow) {
-            partial_--;
-        }
-        completed_++;
-    }
-    ticket.ChangeStatus(new_status);
-    ticket_list_->item(index)->setBackground(ticket.GetStatusColor());
-    UpdateProgress();
+void MainWindow::OnItemDoubleClicked(const QModelIndex& item) {
+    int index = item.row();
+    TicketStatus status = tickets_.View(index).GetStatus();
+    TicketStatus new_status =
+        status == TicketStatus::Green ? TicketStatus::Yellow : TicketStatus::Green;
+    ticket_model_->ChangeStatus(index, new_status);
+    archive_.RecordStatus(index, new_status);
 }
 
 void MainWindow::OnNameEditChanged() {
     if (current_index_ == -1) {
         return;
     }
-    Ticket& current_ticket = tickets_[current_index_];
     QString name = name_edit_->text();
     if (name.isEmpty()) {
         return;
     }
-    current_ticket.Rename(name_edit_->text());
+    search_index_.Remove(tickets_, current_index_);
+    tickets_.Rename(current_index_, name);
+    search_index_.Insert(tickets_, current_index_);
+    archive_.RecordRename(current_index_, name);
     name_label_->setText("Название: " + name);
-    ticket_list_->item(current_index_)->setText(name);
+    ticket_model_->NotifyRowChanged(current_index_);
 }
 
 void MainWindow::OnStatusChanged(int index) {
     if (current_index_ == -1) {
         return;
     }
-    Ticket& ticket = tickets_[current_index_];
-    auto [_, name, status, hint] = ticket.GetPrivate();
-    if (status == TicketStatus::Green) {
-        completed_--;
-    } else if (status == TicketStatus::Yellow) {
-        partial_--;
-    }
+    TicketStatus status = tickets_.View(current_index_).GetStatus();
     auto new_status = static_cast<TicketStatus>(index);
-    if (new_status == TicketStatus::Green) {
-        completed_++;
-    } else if (new_status == TicketStatus::Yellow) {
-        partial_++;
+    if (new_status == status) {
+        return;
     }
-    ticket.ChangeStatus(new_status);
-    ticket_list_->item(current_index_)->setBackground(ticket.GetStatusColor());
-    UpdateProgress();
+    ticket_model_->ChangeStatus(current_index_, new_status);
+    archive_.RecordStatus(current_index_, new_status);
 }
 
 void MainWindow::OnNextClicked() {
-    QVector<int> available;
-    for (const auto& ticket : tickets_) {
-        auto [index, name, status, _] = ticket.GetPrivate();
-        if (status != TicketStatus::Green) {
-            available.append(static_cast<int>(index));
+    auto index = static_cast<int>(tickets_.Scheduler().Pick(QRandomGenerator::global()));
+    if (index == -1) {
+        return;
+    }
+    history_.Visit(current_index_, index);
+    ShowTicket(index);
+}
+
+void MainWindow::OnPreviousClicked() {
+    int index = history_.GoBack(current_index_);
+    if (index == -1) {
+        return;
+    }
+    ShowTicket(index);
+}
+
+void MainWindow::OnForwardClicked() {
+    int index = history_.GoForward(current_index_);
+    if (index == -1) {
+        return;
+    }
+    ShowTicket(index);
+}
+
+void MainWindow::OnImportTriggered() {
+    const QString file_name =
+        QFileDialog::getOpenFileName(this, "Импорт билетов", ".", "CSV (*.csv)");
+    if (file_name.isEmpty()) {
+        return;
+    }
+    QFile file(file_name);
+    if (!file.open(QFile::ReadOnly)) {
+        QMessageBox::warning(this, "Импорт", "Не удалось открыть файл");
+        return;
+    }
+    bool imported = false;
+    ticket_model_->Reset([&](TicketStore* store) {
+        imported = ImportTicketsCsv(&file, store);
+        if (!imported) {
+            // Everything before the import is already on disk.
+            archive_.Load(store);
         }
+    });
+    if (!imported) {
+        QMessageBox::warning(this, "Импорт", "Файл не является корректным списком билетов");
+    } else {
+        archive_.Compact(tickets_);
     }
+    RefreshAfterReload();
+}
 
-    if (available.isEmpty()) {
+void MainWindow::OnExportTriggered() {
+    const QString file_name =
+        QFileDialog::getSaveFileName(this, "Экспорт билетов", "tickets.csv", "CSV (*.csv)");
+    if (file_name.isEmpty()) {
         return;
     }
+    QFile file(file_name);
+    if (!file.open(QFile::WriteOnly) || !ExportTicketsCsv(tickets_, &file)) {
+        QMessageBox::warning(this, "Экспорт", "Не удалось записать файл");
+    }
+}
 
-    int random_index = static_cast<int>(QRandomGenerator::global()->bounded(available.size()));
-    history_.append(current_index_);
-    current_index_ = available[random_index];
+void MainWindow::RefreshAfterReload() {
+    search_index_.Build(tickets_);
+    history_.Clear();
+    current_index_ = -1;
+    {
+        const QSignalBlocker blocker(count_spin_box_);
+        count_spin_box_->setValue(static_cast<int>(tickets_.Size()));
+    }
     UpdateQuestionView();
-    is_programmatic_selection_ = true;
-    ticket_list_->setCurrentRow(current_index_);
-    is_programmatic_selection_ = false;
+    UpdateProgress();
 }
 
-void MainWindow::OnPreviousClicked() {
-    if (history_.isEmpty()) {
+void MainWindow::OnSearchTextChanged(const QString& text) {
+    search_results_->clear();
+    search_results_->setVisible(!text.trimmed().isEmpty());
+    for (int index : search_index_.Search(tickets_, text, kSearchResultLimit)) {
+        auto* item = new QListWidgetItem(tickets_.Name(index), search_results_);
+        item->setData(Qt::UserRole, index);
+    }
+}
+
+void MainWindow::OnSearchResultClicked(QListWidgetItem* item) {
+    int index = item->data(Qt::UserRole).toInt();
+    if (index >= tickets_.Size()) {
         return;
     }
-    current_index_ = history_.takeLast();
+    history_.Visit(current_index_, index);
+    ShowTicket(index);
+}
+
+void MainWindow::ShowTicket(int index) {
+    current_index_ = index;
+    tickets_.MarkReviewed(index);
     UpdateQuestionView();
     is_programmatic_selection_ = true;
-    ticket_list_->setCurrentRow(current_index_);
+    ticket_list_->setCurrentIndex(ticket_model_->index(current_index_));
     is_programmatic_selection_ = false;
 }
 
@@ -231,44 +333,37 @@ void MainWindow::OnHintEditChanged() {
     if (current_index_ == -1) {
         return;
     }
-    Ticket& ticket = tickets_[current_index_];
-    ticket.SetHint(hint_edit_->text());
+    search_index_.Remove(tickets_, current_index_);
+    tickets_.SetHint(current_index_, hint_edit_->text());
+    search_index_.Insert(tickets_, current_index_);
+    archive_.RecordHint(current_index_, hint_edit_->text());
     hint_label_->setText("Подсказка: " + hint_edit_->text());
 }
 
-void MainWindow::UpdateTicketList() {
-    ticket_list_->clear();
-    for (const auto& ticket : tickets_) {
-        auto [index, name, status, _] = ticket.GetPrivate();
-        auto* item = new QListWidgetItem(name);
-        item->setData(Qt::UserRole, static_cast<int>(index));
-        item->setBackground(ticket.GetStatusColor());
-        ticket_list_->addItem(item);
-    }
-}
-
 void MainWindow::UpdateQuestionView() {
-    if (current_index_ < 0 || current_index_ >= tickets_.size()) {
+    if (current_index_ < 0 || current_index_ >= tickets_.Size()) {
         return;
     }
-    auto [index, name, status, hint] = tickets_[current_index_].GetPrivate();
-    index_label_->setText(QString("Номер: %1").arg(index + 1));
-    name_label_->setText(QString("Название: %1").arg(name));
-    name_edit_->setText(name);
-    hint_label_->setText(QString("Подсказка: %1").arg(hint));
+    TicketView ticket = tickets_.View(current_index_);
+    index_label_->setText(QString("Номер: %1").arg(ticket.GetIndex() + 1));
+    name_label_->setText(QString("Название: %1").arg(ticket.GetName()));
+    name_edit_->setText(ticket.GetName());
+    hint_label_->setText(QString("Подсказка: %1").arg(ticket.GetHint()));
     hint_edit_->clear();
-    status_combo_box_->setCurrentIndex(static_cast<int>(status));
+    status_combo_box_->setCurrentIndex(static_cast<int>(ticket.GetStatus()));
 }
 
 void MainWindow::UpdateProgress() {
-    if (tickets_.isEmpty()) {
+    if (tickets_.IsEmpty()) {
         total_progress_bar_->setValue(0);
         green_progress_bar_->setValue(0);
         return;
     }
-    int n = static_cast<int>(tickets_.size());
-    int completed = 100 * completed_ / n;
-    int total = 100 * (completed_ + partial_) / n;
+    int n = static_cast<int>(tickets_.Size());
+    qsizetype green = tickets_.CountOf(TicketStatus::Green);
+    qsizetype yellow = tickets_.CountOf(TicketStatus::Yellow);
+    int completed = static_cast<int>(100 * green / n);
+    int total = static_cast<int>(100 * (green + yellow) / n);
     total_progress_bar_->setValue(total);
     green_progress_bar_->setValue(completed);
 }
@@ -1,23 +1,30 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
-#include "ticket.h"
+#include "navigation_history.h"
+#include "ticket_archive.h"
+#include "ticket_search_index.h"
+#include "ticket_store.h"
 
 #include <QMainWindow>
 
 QT_BEGIN_NAMESPACE
 class QProgressBar;
 class QSpinBox;
+class QListView;
 class QListWidget;
+class QListWidgetItem;
 class QGroupBox;
 class QLabel;
 class QPushButton;
 class QLineEdit;
 class QComboBox;
-class QListWidgetItem;
+class QModelIndex;
 class QTimer;
 QT_END_NAMESPACE
 
+class TicketListModel;
+
 class MainWindow : public QMainWindow {  // NOLINT
     Q_OBJECT
 
@@ -29,14 +36,20 @@ class MainWindow : public QMainWindow {  // NOLINT
     void OnItemSelectionChanged();
     void OnNameEditChanged();
     void OnStatusChanged(int index);
-    void OnItemDoubleClicked(QListWidgetItem* item);
+    void OnItemDoubleClicked(const QModelIndex& item);
     void OnNextClicked();
     void OnPreviousClicked();
+    void OnForwardClicked();
     void OnHintEditChanged();
+    void OnSearchTextChanged(const QString& text);
+    void OnSearchResultClicked(QListWidgetItem* item);
+    void OnImportTriggered();
+    void OnExportTriggered();
 
    private:  // NOLINT
     void SetupUI();
-    void UpdateTicketList();
+    void ShowTicket(int index);
+    void RefreshAfterReload();
     void UpdateQuestionView();
     void UpdateProgress();
 
@@ -48,16 +61,20 @@ class MainWindow : public QMainWindow {  // NOLINT
     QLineEdit* hint_edit_;
     QComboBox* status_combo_box_;
     QSpinBox* count_spin_box_;
-    QListWidget* ticket_list_;
+    QLineEdit* search_edit_;
+    QListWidget* search_results_;
+    QListView* ticket_list_;
+    TicketListModel* ticket_model_;
     QPushButton* previous_button_;
+    QPushButton* forward_button_;
     QPushButton* next_button_;
     QProgressBar* total_progress_bar_;
     QProgressBar* green_progress_bar_;
-    QVector<Ticket> tickets_;
-    QVector<int> history_;
+    TicketStore tickets_;
+    TicketArchive archive_;
+    TicketSearchIndex search_index_;
+    NavigationHistory history_;
     int current_index_ = -1;
-    int completed_ = 0;
-    int partial_ = 0;
     bool is_programmatic_selection_ = false;
 };
 
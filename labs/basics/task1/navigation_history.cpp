@@ -0,0 +1,121 @@
+#include "navigation_history.h"
+
+#include <algorithm>
+
+NavigationHistory::NavigationHistory(qsizetype capacity) : back_(capacity), forward_(capacity) {
+}
+
+qsizetype NavigationHistory::Capacity() const {
+    return back_.Capacity();
+}
+
+void NavigationHistory::SetCapacity(qsizetype capacity) {
+    back_.SetCapacity(capacity);
+    forward_.SetCapacity(capacity);
+}
+
+void NavigationHistory::Visit(int from, int to) {
+    if (from == to) {
+        return;
+    }
+    forward_.Clear();
+    if (from == -1 || (back_.Size() > 0 && back_.Top() == from)) {
+        return;
+    }
+    back_.Push(from);
+}
+
+int NavigationHistory::GoBack(int current) {
+    if (!CanGoBack()) {
+        return -1;
+    }
+    if (current != -1) {
+        forward_.Push(current);
+    }
+    return back_.Pop();
+}
+
+int NavigationHistory::GoForward(int current) {
+    if (!CanGoForward()) {
+        return -1;
+    }
+    if (current != -1) {
+        back_.Push(current);
+    }
+    return forward_.Pop();
+}
+
+bool NavigationHistory::CanGoBack() const {
+    return back_.Size() > 0;
+}
+
+bool NavigationHistory::CanGoForward() const {
+    return forward_.Size() > 0;
+}
+
+void NavigationHistory::Truncate(int count) {
+    back_.Truncate(count);
+    forward_.Truncate(count);
+}
+
+void NavigationHistory::Clear() {
+    back_.Clear();
+    forward_.Clear();
+}
+
+NavigationHistory::Ring::Ring(qsizetype capacity) : buffer_(std::max<qsizetype>(capacity, 1)) {
+}
+
+qsizetype NavigationHistory::Ring::Capacity() const {
+    return static_cast<qsizetype>(buffer_.size());
+}
+
+void NavigationHistory::Ring::SetCapacity(qsizetype capacity) {
+    Ring resized(capacity);
+    qsizetype keep = std::min(size_, resized.Capacity());
+    for (qsizetype i = size_ - keep; i < size_; ++i) {
+        resized.Push(Slot(i));
+    }
+    *this = std::move(resized);
+}
+
+qsizetype NavigationHistory::Ring::Size() const {
+    return size_;
+}
+
+int NavigationHistory::Ring::Top() const {
+    return buffer_[(head_ + size_ - 1) % Capacity()];
+}
+
+void NavigationHistory::Ring::Push(int index) {
+    if (size_ == Capacity()) {
+        buffer_[head_] = index;
+        head_ = (head_ + 1) % Capacity();
+        return;
+    }
+    Slot(size_++) = index;
+}
+
+int NavigationHistory::Ring::Pop() {
+    return Slot(--size_);
+}
+
+void NavigationHistory::Ring::Truncate(int count) {
+    qsizetype kept = 0;
+    for (qsizetype i = 0; i < size_; ++i) {
+        int index = Slot(i);
+        if (index < count && (kept == 0 || Slot(kept - 1) != index)) {
+            Slot(kept++) = index;
+        }
+    }
+    size_ = kept;
+}
+
+void NavigationHistory::Ring::Clear() {
+    head_ = 0;
+    size_ = 0;
+}
+
+int& NavigationHistory::Ring::Slot(qsizetype position) {
+    return buffer_[(head_ + position) % Capacity()];
+}
@@ -0,0 +1,56 @@
+#ifndef NAVIGATION_HISTORY_H
+#define NAVIGATION_HISTORY_H
+
+#include <QtGlobal>
+#include <vector>
+
+// Back/forward navigation over ticket indices with a fixed memory footprint. Both directions are
+// ring buffers of the same capacity: once full, the oldest entries are overwritten.
+class NavigationHistory {
+   public:
+    explicit NavigationHistory(qsizetype capacity);
+
+    [[nodiscard]] qsizetype Capacity() const;
+    void SetCapacity(qsizetype capacity);
+
+    // Records a move from `from` to `to`. No-op moves, moves away from "nothing" (-1) and repeats
+    // of the most recent entry are not stored. Any move clears the forward stack.
+    void Visit(int from, int to);
+    // Both return the index to move to, or -1 if there is nowhere to go. `current` is pushed onto
+    // the opposite stack.
+    int GoBack(int current);
+    int GoForward(int current);
+
+    [[nodiscard]] bool CanGoBack() const;
+    [[nodiscard]] bool CanGoForward() const;
+
+    // Forgets every entry that refers to an index >= `count`.
+    void Truncate(int count);
+    void Clear();
+
+   private:
+    class Ring {
+       public:
+        explicit Ring(qsizetype capacity);
+        [[nodiscard]] qsizetype Capacity() const;
+        void SetCapacity(qsizetype capacity);
+        [[nodiscard]] qsizetype Size() const;
+        [[nodiscard]] int Top() const;
+        void Push(int index);
+        int Pop();
+        void Truncate(int count);
+        void Clear();
+
+       private:
+        [[nodiscard]] int& Slot(qsizetype position);
+
+        std::vector<int> buffer_;
+        qsizetype head_ = 0;
+        qsizetype size_ = 0;
+    };
+
+    Ring back_;
+    Ring forward_;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "review_scheduler.h"
+
+#include <QRandomGenerator>
+#include <array>
+#include <bit>
+#include <magic_enum/magic_enum.hpp>
+
+namespace {
+
+constexpr std::array<qint64, magic_enum::enum_count<TicketStatus>()> kStatusWeight = {
+    4,  // Default
+    2,  // Yellow
+    0,  // Green
+};
+
+qint64 StatusWeight(TicketStatus status) {
+    return kStatusWeight[magic_enum::enum_index(status).value()];
+}
+
+}  // namespace
+
+qsizetype ReviewScheduler::Size() const {
+    return static_cast<qsizetype>(base_.size());
+}
+
+void ReviewScheduler::Clear() {
+    base_.clear();
+    last_review_.clear();
+    base_sums_.Clear();
+    stamped_sums_.Clear();
+    clock_ = 0;
+}
+
+void ReviewScheduler::Resize(qsizetype count) {
+    if (count <= Size()) {
+        base_.resize(count);
+        last_review_.resize(count);
+        base_sums_.Truncate(count);
+        stamped_sums_.Truncate(count);
+        return;
+    }
+    for (qsizetype i = Size(); i < count; ++i) {
+        Append(TicketStatus::Default);
+    }
+}
+
+void ReviewScheduler::Append(TicketStatus status) {
+    qint64 base = StatusWeight(status);
+    base_.push_back(static_cast<quint8>(base));
+    last_review_.push_back(clock_);
+    base_sums_.Append(base);
+    stamped_sums_.Append(base * clock_);
+}
+
+void ReviewScheduler::SetStatus(qsizetype index, TicketStatus status) {
+    qint64 base = StatusWeight(status);
+    qint64 delta = base - base_[index];
+    if (delta == 0) {
+        return;
+    }
+    base_[index] = static_cast<quint8>(base);
+    base_sums_.Add(index, delta);
+    stamped_sums_.Add(index, delta * last_review_[index]);
+}
+
+void ReviewScheduler::MarkReviewed(qsizetype index) {
+    ++clock_;
+    qint64 elapsed = clock_ - last_review_[index];
+    last_review_[index] = clock_;
+    stamped_sums_.Add(index, base_[index] * elapsed);
+}
+
+qint64 ReviewScheduler::TotalWeight() const {
+    return (clock_ + 1) * base_sums_.Prefix(Size()) - stamped_sums_.Prefix(Size());
+}
+
+qsizetype ReviewScheduler::Find(qint64 offset) const {
+    // Standard Fenwick descent; every node's combined weight is a sum of non-negative weights,
+    // so skipping whole nodes while they fit below `offset` finds the owning ticket.
+    qsizetype position = 0;
+    for (auto step = static_cast<qsizetype>(std::bit_floor(static_cast<size_t>(Size()))); step > 0;
+         step /= 2) {
+        qsizetype next = position + step;
+        if (next > Size()) {
+            continue;
+        }
+        qint64 weight = (clock_ + 1) * base_sums_.Node(next) - stamped_sums_.Node(next);
+        if (weight <= offset) {
+            position = next;
+            offset -= weight;
+        }
+    }
+    return position;
+}
+
+qsizetype ReviewScheduler::Pick(QRandomGenerator* rng) const {
+    qint64 total = TotalWeight();
+    if (total <= 0) {
+        return -1;
+    }
+    return Find(rng->bounded(total));
+}
+
+qsizetype ReviewScheduler::FenwickTree::Size() const {
+    return static_cast<qsizetype>(nodes_.size()) - 1;
+}
+
+void ReviewScheduler::FenwickTree::Clear() {
+    nodes_.assign(1, 0);
+}
+
+void ReviewScheduler::FenwickTree::Append(qint64 value) {
+    qsizetype node = Size() + 1;
+    qsizetype covered_from = node - (node & -node);
+    nodes_.push_back(value + Prefix(node - 1) - Prefix(covered_from));
+}
+
+void ReviewScheduler::FenwickTree::Truncate(qsizetype count) {
+    // Node i only covers elements up to i, so the first `count` nodes stay valid.
+    nodes_.resize(count + 1);
+}
+
+void ReviewScheduler::FenwickTree::Add(qsizetype index, qint64 delta) {
+    for (qsizetype node = index + 1; node <= Size(); node += node & -node) {
+        nodes_[node] += delta;
+    }
+}
+
+qint64 ReviewScheduler::FenwickTree::Prefix(qsizetype count) const {
+    qint64 sum = 0;
+    for (qsizetype node = count; node > 0; node -= node & -node) {
+        sum += nodes_[node];
+    }
+    return sum;
+}
+
+qint64 ReviewScheduler::FenwickTree::Node(qsizetype node) const {
+    return nodes_[node];
+}
@@ -0,0 +1,60 @@
+#ifndef REVIEW_SCHEDULER_H
+#define REVIEW_SCHEDULER_H
+
+#include "ticket.h"
+
+#include <QtGlobal>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QRandomGenerator;
+QT_END_NAMESPACE
+
+// Weighted random choice of the next ticket to review. A ticket's weight is its status weight
+// times the number of reviews since it was last seen, so neglected unfinished tickets come up
+// more often and finished ones never do.
+//
+// Weights depend on the global review clock, which would make every tick an O(n) update. Instead
+// w_i = b_i * (now + 1 - t_i) = (now + 1) * b_i - b_i * t_i, and two Fenwick trees hold the sums
+// of b_i and b_i * t_i. Updates, picks and the total weight are all O(log n).
+class ReviewScheduler {
+   public:
+    [[nodiscard]] qsizetype Size() const;
+    void Clear();
+    // New tickets are Default and count as just seen.
+    void Resize(qsizetype count);
+    // Adds one ticket that counts as just seen, in amortized O(log n).
+    void Append(TicketStatus status);
+    void SetStatus(qsizetype index, TicketStatus status);
+    void MarkReviewed(qsizetype index);
+
+    [[nodiscard]] qint64 TotalWeight() const;
+    // Ticket whose weight interval contains `offset`, for 0 <= offset < TotalWeight().
+    [[nodiscard]] qsizetype Find(qint64 offset) const;
+    // Random ticket drawn proportionally to weight, or -1 if every weight is zero.
+    [[nodiscard]] qsizetype Pick(QRandomGenerator* rng) const;
+
+   private:
+    class FenwickTree {
+       public:
+        [[nodiscard]] qsizetype Size() const;
+        void Clear();
+        void Append(qint64 value);
+        void Truncate(qsizetype count);
+        void Add(qsizetype index, qint64 delta);
+        [[nodiscard]] qint64 Prefix(qsizetype count) const;
+        // 1-based node array; node i covers (i - lowbit(i), i].
+        [[nodiscard]] qint64 Node(qsizetype node) const;
+
+       private:
+        std::vector<qint64> nodes_ = {0};
+    };
+
+    std::vector<quint8> base_;
+    std::vector<quint32> last_review_;
+    FenwickTree base_sums_;
+    FenwickTree stamped_sums_;
+    quint32 clock_ = 0;
+};
+
+#endif
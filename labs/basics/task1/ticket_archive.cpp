@@ -0,0 +1,250 @@
+#include "ticket_archive.h"
+
+#include <QDir>
+#include <QSaveFile>
+#include <cstring>
+#include <magic_enum/magic_enum.hpp>
+
+namespace {
+
+constexpr quint32 kSnapshotMagic = 0x314B'5454;  // "TTK1"
+constexpr quint32 kSnapshotVersion = 1;
+
+enum JournalOp : quint8 { kResize, kRename, kStatus, kHint };
+
+struct SnapshotHeader {
+    quint32 magic;
+    quint32 version;
+    quint64 count;
+    quint64 name_count;
+    quint64 hint_count;
+};
+
+// Names and hints are stored sparsely: only tickets with a custom name or a non-empty hint
+// have an entry, followed by `length` UTF-16 code units.
+struct TextEntry {
+    quint32 index;
+    quint32 length;
+};
+
+struct JournalRecord {
+    quint8 op;
+    quint8 status;
+    quint16 reserved;
+    quint32 index;
+    quint32 length;
+};
+
+bool IsValidStatus(quint8 status) {
+    return magic_enum::enum_contains<TicketStatus>(static_cast<int8_t>(status));
+}
+
+template <class T>
+bool ReadPod(const uchar*& data, const uchar* end, T* value) {
+    if (end - data < static_cast<qint64>(sizeof(T))) {
+        return false;
+    }
+    std::memcpy(value, data, sizeof(T));
+    data += sizeof(T);
+    return true;
+}
+
+bool ReadText(const uchar*& data, const uchar* end, quint32 length, QString* text) {
+    qint64 bytes = static_cast<qint64>(length) * static_cast<qint64>(sizeof(QChar));
+    if (end - data < bytes) {
+        return false;
+    }
+    *text = QString(length, Qt::Uninitialized);
+    std::memcpy(text->data(), data, bytes);
+    data += bytes;
+    return true;
+}
+
+void WriteText(QSaveFile* file, qsizetype index, const QString& text) {
+    TextEntry entry{static_cast<quint32>(index), static_cast<quint32>(text.size())};
+    file->write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    file->write(
+        reinterpret_cast<const char*>(text.constData()),
+        text.size() * static_cast<qint64>(sizeof(QChar)));
+}
+
+// Applies complete journal records and returns the length of the valid prefix.
+qint64 Replay(const uchar* data, qint64 size, TicketStore* store) {
+    const uchar* end = data + size;
+    const uchar* cursor = data;
+    const uchar* last_valid = data;
+    JournalRecord record{};
+    QString text;
+    while (ReadPod(cursor, end, &record) && ReadText(cursor, end, record.length, &text)) {
+        if (record.op == kResize) {
+            if (record.index > kMaxTicketCount) {
+                // No edit asks for that many tickets: the record is garbage, as is the rest.
+                break;
+            }
+            store->Resize(record.index);
+        } else if (record.index < store->Size()) {
+            switch (record.op) {
+                case kRename:
+                    store->Rename(record.index, text);
+                    break;
+                case kStatus:
+                    if (IsValidStatus(record.status)) {
+                        store->ChangeStatus(record.index, static_cast<TicketStatus>(record.status));
+                    }
+                    break;
+                case kHint:
+                    store->SetHint(record.index, text);
+                    break;
+                default:
+                    break;
+            }
+        }
+        last_valid = cursor;
+    }
+    return last_valid - data;
+}
+
+}  // namespace
+
+TicketArchive::TicketArchive(const QString& directory)
+    : snapshot_path_(QDir(directory).filePath("tickets.snapshot"))
+    , journal_(QDir(directory).filePath("tickets.journal")) {
+    QDir().mkpath(directory);
+}
+
+bool TicketArchive::Load(TicketStore* store) {
+    store->Clear();
+    writable_ = false;
+    journal_.close();
+    if (!journal_.open(QFile::ReadWrite)) {
+        return false;
+    }
+    if (!LoadSnapshot(store)) {
+        // The failure may be transient, or the files may come from a newer version: keep them.
+        store->Clear();
+        journal_.close();
+        return false;
+    }
+    if (journal_.size() > 0) {
+        const uchar* data = journal_.map(0, journal_.size());
+        if (data == nullptr) {
+            store->Clear();
+            journal_.close();
+            return false;
+        }
+        qint64 valid = Replay(data, journal_.size(), store);
+        journal_.unmap(const_cast<uchar*>(data));
+        // Drop a record torn by a crash so that new appends stay readable.
+        journal_.resize(valid);
+    }
+    journal_.seek(journal_.size());
+    writable_ = true;
+    return true;
+}
+
+bool TicketArchive::LoadSnapshot(TicketStore* store) const {
+    QFile snapshot(snapshot_path_);
+    if (!snapshot.exists() || snapshot.size() == 0) {
+        return true;
+    }
+    if (!snapshot.open(QFile::ReadOnly)) {
+        return false;
+    }
+    const uchar* data = snapshot.map(0, snapshot.size());
+    if (data == nullptr) {
+        return false;
+    }
+    const uchar* end = data + snapshot.size();
+    const uchar* cursor = data;
+    SnapshotHeader header{};
+    if (!ReadPod(cursor, end, &header) || header.magic != kSnapshotMagic ||
+        header.version != kSnapshotVersion ||
+        header.count > static_cast<quint64>(kMaxTicketCount) ||
+        end - cursor < static_cast<qint64>(header.count)) {
+        return false;
+    }
+    store->Resize(static_cast<qsizetype>(header.count));
+    for (qsizetype i = 0, count = store->Size(); i < count; ++i) {
+        if (cursor[i] != static_cast<uchar>(TicketStatus::Default) && IsValidStatus(cursor[i])) {
+            store->ChangeStatus(i, static_cast<TicketStatus>(cursor[i]));
+        }
+    }
+    cursor += header.count;
+    QString text;
+    TextEntry entry{};
+    for (quint64 i = 0; i < header.name_count + header.hint_count; ++i) {
+        if (!ReadPod(cursor, end, &entry) || !ReadText(cursor, end, entry.length, &text) ||
+            entry.index >= header.count) {
+            return false;
+        }
+        if (i < header.name_count) {
+            store->Rename(entry.index, text);
+        } else {
+            store->SetHint(entry.index, text);
+        }
+    }
+    return true;
+}
+
+bool TicketArchive::Compact(const TicketStore& store) {
+    if (!writable_) {
+        return false;
+    }
+    QSaveFile snapshot(snapshot_path_);
+    if (!snapshot.open(QFile::WriteOnly)) {
+        return false;
+    }
+    qsizetype count = store.Size();
+    SnapshotHeader header{kSnapshotMagic, kSnapshotVersion, static_cast<quint64>(count), 0, 0};
+    QByteArray statuses(count, Qt::Uninitialized);
+    for (qsizetype i = 0; i < count; ++i) {
+        statuses[i] = static_cast<char>(store.Status(i));
+        header.name_count += store.HasCustomName(i) ? 1 : 0;
+        header.hint_count += store.Hint(i).isEmpty() ? 0 : 1;
+    }
+    snapshot.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    snapshot.write(statuses);
+    for (qsizetype i = 0; i < count; ++i) {
+        if (store.HasCustomName(i)) {
+            WriteText(&snapshot, i, store.Name(i));
+        }
+    }
+    for (qsizetype i = 0; i < count; ++i) {
+        if (!store.Hint(i).isEmpty()) {
+            WriteText(&snapshot, i, store.Hint(i));
+        }
+    }
+    if (!snapshot.commit()) {
+        return false;
+    }
+    return journal_.resize(0);
+}
+
+void TicketArchive::RecordResize(qsizetype count) {
+    Append(kResize, 0, count, {});
+}
+
+void TicketArchive::RecordRename(qsizetype index, const QString& name) {
+    Append(kRename, 0, index, name);
+}
+
+void TicketArchive::RecordStatus(qsizetype index, TicketStatus status) {
+    Append(kStatus, static_cast<quint8>(status), index, {});
+}
+
+void TicketArchive::RecordHint(qsizetype index, const QString& hint) {
+    Append(kHint, 0, index, hint);
+}
+
+void TicketArchive::Append(quint8 op, quint8 status, qsizetype index, const QString& text) {
+    if (!journal_.isOpen()) {
+        return;
+    }
+    JournalRecord record{
+        op, status, 0, static_cast<quint32>(index), static_cast<quint32>(text.size())};
+    journal_.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    journal_.write(
+        reinterpret_cast<const char*>(text.constData()),
+        text.size() * static_cast<qint64>(sizeof(QChar)));
+    journal_.flush();
+}
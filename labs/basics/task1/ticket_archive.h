@@ -0,0 +1,39 @@
+#ifndef TICKET_ARCHIVE_H
+#define TICKET_ARCHIVE_H
+
+#include "ticket_store.h"
+
+#include <QFile>
+#include <QString>
+
+// On-disk ticket state: a compact binary snapshot plus an append-only journal of the edits made
+// since the snapshot was written. Every edit is a single small append; Compact folds the journal
+// back into a fresh snapshot.
+//
+// Both files use the host byte order and are not meant to be moved between machines.
+class TicketArchive {
+   public:
+    explicit TicketArchive(const QString& directory);
+
+    // Replaces the contents of `store` with the snapshot and replays the journal on top of it.
+    // On failure the store is left empty and both files are left untouched: recording and
+    // compaction are disabled until a later Load succeeds, so a broken or newer archive is never
+    // overwritten.
+    bool Load(TicketStore* store);
+    bool Compact(const TicketStore& store);
+
+    void RecordResize(qsizetype count);
+    void RecordRename(qsizetype index, const QString& name);
+    void RecordStatus(qsizetype index, TicketStatus status);
+    void RecordHint(qsizetype index, const QString& hint);
+
+   private:
+    void Append(quint8 op, quint8 status, qsizetype index, const QString& text);
+    bool LoadSnapshot(TicketStore* store) const;
+
+    QString snapshot_path_;
+    QFile journal_;
+    bool writable_ = false;
+};
+
+#endif
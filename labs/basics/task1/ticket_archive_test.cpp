@@ -0,0 +1,29 @@
+#include "ticket_archive.h"
+#include "ticket_store.h"
+
+#include <QTemporaryDir>
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+
+TEST_CASE("Journal replay stops at an impossible resize") {
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    {
+        TicketArchive archive(dir.path());
+        TicketStore store;
+        REQUIRE(archive.Load(&store));
+        archive.RecordResize(3);
+        archive.RecordResize(std::numeric_limits<quint32>::max());
+        archive.RecordResize(5);
+    }
+    TicketArchive archive(dir.path());
+    TicketStore store;
+    REQUIRE(archive.Load(&store));
+    CHECK(store.Size() == 3);
+
+    // The corrupt tail is dropped, so new edits follow the last good record.
+    archive.RecordResize(4);
+    TicketStore reloaded;
+    REQUIRE(TicketArchive(dir.path()).Load(&reloaded));
+    CHECK(reloaded.Size() == 4);
+}
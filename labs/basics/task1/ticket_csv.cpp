@@ -0,0 +1,73 @@
+#include "ticket_csv.h"
+
+#include "utils/csv_export.h"
+
+#include <QIODevice>
+#include <magic_enum/magic_enum.hpp>
+#include <string_view>
+
+namespace {
+
+constexpr char16_t kHeader[] = u"name,status,hint";
+
+std::string_view ToStringView(QByteArrayView bytes) {
+    return {bytes.data(), static_cast<size_t>(bytes.size())};
+}
+
+QString FromField(QByteArrayView field) {
+    return field.isEmpty() ? QString() : QString::fromUtf8(field);
+}
+
+}  // namespace
+
+bool ImportTicketsCsv(QIODevice* device, TicketStore* store) {
+    outfit::utils::csv::CsvReader reader(device);
+    store->Clear();
+    if (!reader.ReadRow()) {
+        return !reader.HasError();
+    }
+    if (reader.FieldCount() == 3 && ToStringView(reader.Field(0)) == "name" &&
+        ToStringView(reader.Field(1)) == "status") {
+        if (!reader.ReadRow()) {
+            return !reader.HasError();
+        }
+    }
+    do {
+        if (reader.FieldCount() == 1 && reader.Field(0).isEmpty()) {
+            continue;
+        }
+        qsizetype index = store->Size();
+        if (index == kMaxTicketCount) {
+            return false;
+        }
+        QByteArrayView name = reader.Field(0);
+        TicketStatus status = TicketStatus::Default;
+        if (reader.FieldCount() > 1 && !reader.Field(1).isEmpty()) {
+            auto parsed = magic_enum::enum_cast<TicketStatus>(ToStringView(reader.Field(1)));
+            if (!parsed.has_value()) {
+                return false;
+            }
+            status = *parsed;
+        }
+        QByteArrayView hint = reader.FieldCount() > 2 ? reader.Field(2) : QByteArrayView();
+        store->Append(
+            TicketStore::IsDefaultName(name, index) ? QString() : FromField(name), status,
+            FromField(hint));
+    } while (reader.ReadRow());
+    return !reader.HasError();
+}
+
+bool ExportTicketsCsv(const TicketStore& store, QIODevice* device) {
+    outfit::utils::csv::CsvWriter writer(device);
+    writer.WriteRaw(kHeader);
+    writer.EndRow();
+    for (qsizetype i = 0, size = store.Size(); i < size; ++i) {
+        TicketView ticket = store.View(i);
+        writer.WriteField(ticket.GetName());
+        std::string_view status = magic_enum::enum_name(ticket.GetStatus());
+        writer.WriteField(QByteArrayView(status.data(), static_cast<qsizetype>(status.size())));
+        writer.WriteField(ticket.GetHint());
+        writer.EndRow();
+    }
+    return writer.Flush();
+}
@@ -0,0 +1,19 @@
+#ifndef TICKET_CSV_H
+#define TICKET_CSV_H
+
+#include "ticket_store.h"
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+// Ticket exchange format: an optional "name,status,hint" header followed by one UTF-8 row per
+// ticket, in deck order. Status is the TicketStatus enumerator name. Blank lines are skipped, and a
+// file with more than kMaxTicketCount tickets is rejected.
+//
+// Import streams rows straight into `store`, replacing its contents. On failure the store holds
+// whatever was read so far and the caller is expected to restore it.
+bool ImportTicketsCsv(QIODevice* device, TicketStore* store);
+bool ExportTicketsCsv(const TicketStore& store, QIODevice* device);
+
+#endif
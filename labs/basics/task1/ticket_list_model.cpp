@@ -0,0 +1,86 @@
+#include "ticket_list_model.h"
+
+#include <algorithm>
+
+TicketListModel::TicketListModel(TicketStore* store, QObject* parent)
+    : QAbstractListModel(parent), store_(store) {
+}
+
+int TicketListModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(store_->Size());
+}
+
+QVariant TicketListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= store_->Size()) {
+        return {};
+    }
+    TicketView ticket = store_->View(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            return ticket.GetName();
+        case Qt::BackgroundRole:
+            return ticket.GetStatusColor();
+        default:
+            return {};
+    }
+}
+
+void TicketListModel::Resize(int count) {
+    int size = static_cast<int>(store_->Size());
+    if (count > size) {
+        beginInsertRows({}, size, count - 1);
+        store_->Resize(count);
+        endInsertRows();
+    } else if (count < size) {
+        beginRemoveRows({}, count, size - 1);
+        store_->Resize(count);
+        endRemoveRows();
+    }
+}
+
+void TicketListModel::ChangeStatus(int row, TicketStatus status) {
+    store_->ChangeStatus(row, status);
+    NotifyRowChanged(row);
+}
+
+void TicketListModel::NotifyRowChanged(int row) {
+    if (dirty_first_ == -1) {
+        dirty_first_ = row;
+        dirty_last_ = row;
+        if (batch_depth_ == 0) {
+            QMetaObject::invokeMethod(this, &TicketListModel::Flush, Qt::QueuedConnection);
+        }
+        return;
+    }
+    dirty_first_ = std::min(dirty_first_, row);
+    dirty_last_ = std::max(dirty_last_, row);
+}
+
+void TicketListModel::BeginBatch() {
+    ++batch_depth_;
+}
+
+void TicketListModel::EndBatch() {
+    if (--batch_depth_ == 0) {
+        Flush();
+    }
+}
+
+void TicketListModel::Flush() {
+    // A queued flush may find its rows already reported by EndBatch, or a batch still open.
+    if (batch_depth_ > 0 || dirty_first_ == -1) {
+        return;
+    }
+    // Rows may have been removed since they were marked.
+    int first = dirty_first_;
+    int last = std::min(dirty_last_, rowCount({}) - 1);
+    dirty_first_ = -1;
+    dirty_last_ = -1;
+    if (first <= last) {
+        emit dataChanged(index(first), index(last), {Qt::DisplayRole, Qt::BackgroundRole});
+    }
+    emit TicketsChanged();
+}
@@ -0,0 +1,52 @@
+#ifndef TICKET_LIST_MODEL_H
+#define TICKET_LIST_MODEL_H
+
+#include "ticket_store.h"
+
+#include <QAbstractListModel>
+
+// List model over a TicketStore. The view only asks for visible rows, so no
+// per-ticket item objects are ever allocated.
+//
+// Edits are written to the store immediately, but the view hears about them later, as a single
+// dataChanged over the touched range followed by one TicketsChanged:
+//  - between BeginBatch and the matching EndBatch, when the outermost EndBatch returns;
+//  - otherwise, on the next event loop turn, for everything changed during the current one.
+// Callers that need a bulk edit reported as one change, independent of when control returns to
+// the event loop, wrap it in a batch.
+class TicketListModel : public QAbstractListModel {  // NOLINT
+    Q_OBJECT
+
+   public:
+    explicit TicketListModel(TicketStore* store, QObject* parent = nullptr);
+
+    [[nodiscard]] int rowCount(const QModelIndex& parent) const override;
+    [[nodiscard]] QVariant data(const QModelIndex& index, int role) const override;
+
+    // Runs `update` on the store between beginResetModel and endResetModel.
+    template <class F>
+    void Reset(F&& update) {
+        beginResetModel();
+        update(store_);
+        endResetModel();
+    }
+    void Resize(int count);
+    void ChangeStatus(int row, TicketStatus status);
+    void NotifyRowChanged(int row);
+    // Batches nest; only the outermost EndBatch reports the changes.
+    void BeginBatch();
+    void EndBatch();
+
+   signals:
+    void TicketsChanged();
+
+   private:
+    void Flush();
+
+    TicketStore* store_;
+    int dirty_first_ = -1;
+    int dirty_last_ = -1;
+    int batch_depth_ = 0;
+};
+
+#endif
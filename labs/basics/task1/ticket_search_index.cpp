@@ -0,0 +1,192 @@
+#include "ticket_search_index.h"
+
+#include <QString>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+
+// A query must share at least this fraction of its trigrams with a ticket to be reported.
+constexpr double kMinSimilarity = 0.3;
+// Upper bound on the tickets scored per query. Only very unselective queries, such as a single
+// common letter, reach it; they then rank the lowest-numbered matching tickets.
+constexpr size_t kMaxCandidates = 20'000;
+
+}  // namespace
+
+void TicketSearchIndex::Build(const TicketStore& store) {
+    Clear();
+    for (qsizetype i = 0, size = store.Size(); i < size; ++i) {
+        Insert(store, i);
+    }
+}
+
+void TicketSearchIndex::Insert(const TicketStore& store, qsizetype index) {
+    const auto doc = static_cast<int>(index);
+    for (Trigram trigram : Trigrams(store, index)) {
+        std::vector<int>& docs = postings_[trigram];
+        // Build and new tickets append in order; only edits of older tickets pay for the insert.
+        if (docs.empty() || docs.back() < doc) {
+            docs.push_back(doc);
+        } else if (auto it = std::ranges::lower_bound(docs, doc); it == docs.end() || *it != doc) {
+            docs.insert(it, doc);
+        }
+    }
+}
+
+void TicketSearchIndex::Remove(const TicketStore& store, qsizetype index) {
+    const auto doc = static_cast<int>(index);
+    for (Trigram trigram : Trigrams(store, index)) {
+        auto it = postings_.find(trigram);
+        if (it == postings_.end()) {
+            continue;
+        }
+        std::vector<int>& docs = it.value();
+        auto position = std::ranges::lower_bound(docs, doc);
+        if (position != docs.end() && *position == doc) {
+            docs.erase(position);
+        }
+        if (docs.empty()) {
+            postings_.erase(it);
+        }
+    }
+}
+
+void TicketSearchIndex::Clear() {
+    postings_.clear();
+}
+
+QVector<int> TicketSearchIndex::Search(
+    const TicketStore& store, QStringView query, qsizetype limit) const {
+    QVector<int> results;
+    if (limit <= 0) {
+        return results;
+    }
+
+    std::vector<Trigram> trigrams = Trigrams(query);
+    if (!trigrams.empty()) {
+        std::vector<std::pair<int, int>> ranked = Score(trigrams);
+        auto by_score = [](const auto& lhs, const auto& rhs) {
+            return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second;
+        };
+        auto take = std::min(limit, static_cast<qsizetype>(ranked.size()));
+        std::partial_sort(ranked.begin(), ranked.begin() + take, ranked.end(), by_score);
+        results.reserve(limit);
+        for (qsizetype i = 0; i < take; ++i) {
+            results.append(ranked[i].second);
+        }
+    }
+
+    // Default names come after text matches: "12" matches tickets 12, 120-129, 1200-1299 and so
+    // on, in that order.
+    QStringView digits = query.trimmed();
+    while (!digits.isEmpty() && !digits.front().isDigit()) {
+        digits = digits.sliced(1);
+    }
+    qsizetype digit_count = 0;
+    while (digit_count < digits.size() && digits[digit_count].isDigit()) {
+        ++digit_count;
+    }
+    bool ok = false;
+    qint64 number = digits.first(digit_count).toLongLong(&ok);
+    if (!ok || number <= 0) {
+        return results;
+    }
+    qsizetype text_matches = results.size();
+    for (qint64 low = number, high = number; low <= store.Size() && results.size() < limit;
+         low *= 10, high = high * 10 + 9) {
+        for (qint64 n = low, last = std::min<qint64>(high, store.Size());
+             n <= last && results.size() < limit; ++n) {
+            auto index = static_cast<int>(n - 1);
+            auto text_end = results.cbegin() + text_matches;
+            if (!store.HasCustomName(index) &&
+                std::find(results.cbegin(), text_end, index) == text_end) {
+                results.append(index);
+            }
+        }
+    }
+    return results;
+}
+
+std::vector<std::pair<int, int>> TicketSearchIndex::Score(
+    const std::vector<Trigram>& trigrams) const {
+    std::vector<const std::vector<int>*> lists;
+    for (Trigram trigram : trigrams) {
+        auto it = postings_.constFind(trigram);
+        if (it != postings_.cend()) {
+            lists.push_back(&it.value());
+        }
+    }
+    const auto min_hits = std::max<qsizetype>(
+        1, static_cast<qsizetype>(kMinSimilarity * static_cast<double>(trigrams.size())));
+    // A ticket sharing min_hits of the query's trigrams is in at least one of the shortest
+    // lists.size() - min_hits + 1 posting lists; only those are walked, the rest are probed.
+    const auto walked = static_cast<qsizetype>(lists.size()) - min_hits + 1;
+    if (walked <= 0) {
+        return {};
+    }
+    std::ranges::sort(lists, {}, [](const std::vector<int>* docs) { return docs->size(); });
+
+    // Merges the walked lists in ticket order; each heap entry is {ticket, list}.
+    using Cursor = std::pair<int, qsizetype>;
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<>> heap;
+    std::vector<size_t> positions(walked, 0);
+    for (qsizetype list = 0; list < walked; ++list) {
+        heap.emplace(lists[list]->front(), list);
+    }
+    std::vector<std::pair<int, int>> ranked;
+    size_t candidates = 0;
+    while (!heap.empty() && candidates++ < kMaxCandidates) {
+        const int doc = heap.top().first;
+        int hits = 0;
+        while (!heap.empty() && heap.top().first == doc) {
+            qsizetype list = heap.top().second;
+            heap.pop();
+            ++hits;
+            if (++positions[list] < lists[list]->size()) {
+                heap.emplace((*lists[list])[positions[list]], list);
+            }
+        }
+        for (auto list = lists.begin() + walked; list != lists.end(); ++list) {
+            hits += std::ranges::binary_search(**list, doc) ? 1 : 0;
+        }
+        if (hits >= min_hits) {
+            ranked.emplace_back(hits, doc);
+        }
+    }
+    return ranked;
+}
+
+std::vector<TicketSearchIndex::Trigram> TicketSearchIndex::Trigrams(QStringView text) {
+    std::vector<Trigram> trigrams;
+    QString folded = text.toString().toCaseFolded();
+    qsizetype i = 0;
+    while (i < folded.size()) {
+        if (!folded[i].isLetterOrNumber()) {
+            ++i;
+            continue;
+        }
+        // Each word is padded as "  word " so that short queries still yield prefix trigrams.
+        Trigram window = (Trigram{u' '} << 16) | u' ';
+        for (; i < folded.size() && folded[i].isLetterOrNumber(); ++i) {
+            window = ((window << 16) | folded[i].unicode()) & 0xFFFF'FFFF'FFFFULL;
+            trigrams.push_back(window);
+        }
+        trigrams.push_back(((window << 16) | u' ') & 0xFFFF'FFFF'FFFFULL);
+    }
+    std::ranges::sort(trigrams);
+    auto [first, last] = std::ranges::unique(trigrams);
+    trigrams.erase(first, last);
+    return trigrams;
+}
+
+std::vector<TicketSearchIndex::Trigram> TicketSearchIndex::Trigrams(
+    const TicketStore& store, qsizetype index) {
+    const QString& hint = store.Hint(index);
+    if (!store.HasCustomName(index)) {
+        return Trigrams(hint);
+    }
+    return Trigrams(QString(store.Name(index) + u' ' + hint));
+}
@@ -0,0 +1,41 @@
+#ifndef TICKET_SEARCH_INDEX_H
+#define TICKET_SEARCH_INDEX_H
+
+#include "ticket_store.h"
+
+#include <QHash>
+#include <QStringView>
+#include <QVector>
+#include <utility>
+#include <vector>
+
+// Trigram index over custom ticket names and hints. Default "Билет N" names are never indexed:
+// queries that contain a number are matched against them arithmetically instead.
+//
+// Callers keep the index in sync by calling Remove before and Insert after editing a ticket.
+class TicketSearchIndex {
+   public:
+    void Build(const TicketStore& store);
+    void Insert(const TicketStore& store, qsizetype index);
+    void Remove(const TicketStore& store, qsizetype index);
+    void Clear();
+
+    // Ticket indices ordered by decreasing similarity to `query`, at most `limit` of them.
+    [[nodiscard]] QVector<int> Search(
+        const TicketStore& store, QStringView query, qsizetype limit) const;
+
+   private:
+    using Trigram = quint64;
+
+    // {shared trigram count, ticket} for tickets that share enough of `trigrams`, unordered.
+    [[nodiscard]] std::vector<std::pair<int, int>> Score(
+        const std::vector<Trigram>& trigrams) const;
+
+    static std::vector<Trigram> Trigrams(QStringView text);
+    static std::vector<Trigram> Trigrams(const TicketStore& store, qsizetype index);
+
+    // Ticket indices in increasing order, so removal and probing are binary searches.
+    QHash<Trigram, std::vector<int>> postings_;
+};
+
+#endif
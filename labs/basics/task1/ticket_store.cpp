@@ -0,0 +1,146 @@
+#include "ticket_store.h"
+
+#include <charconv>
+#include <string_view>
+
+namespace {
+constexpr std::string_view kDefaultNamePrefix = "Билет ";
+}  // namespace
+
+qsizetype TicketStore::Size() const {
+    return static_cast<qsizetype>(statuses_.size());
+}
+
+bool TicketStore::IsEmpty() const {
+    return statuses_.empty();
+}
+
+void TicketStore::Clear() {
+    statuses_.clear();
+    names_.clear();
+    hints_.clear();
+    scheduler_.Clear();
+    status_counts_.fill(0);
+}
+
+void TicketStore::Append(QString name, TicketStatus status, QString hint) {
+    scheduler_.Append(status);
+    statuses_.push_back(status);
+    ++status_counts_[magic_enum::enum_index(status).value()];
+    if (!name.isNull()) {
+        names_.insert(static_cast<int>(Size() - 1), std::move(name));
+    }
+    if (!hint.isEmpty()) {
+        hints_.insert(static_cast<int>(Size() - 1), std::move(hint));
+    }
+}
+
+void TicketStore::Resize(qsizetype count) {
+    qsizetype size = Size();
+    for (qsizetype i = count; i < size; ++i) {
+        --status_counts_[magic_enum::enum_index(statuses_[i]).value()];
+    }
+    scheduler_.Resize(count);
+    if (count > size) {
+        status_counts_[magic_enum::enum_index(TicketStatus::Default).value()] += count - size;
+    }
+    statuses_.resize(count, TicketStatus::Default);
+    if (count < size) {
+        auto is_dropped = [count](QHash<int, QString>::iterator it) { return it.key() >= count; };
+        names_.removeIf(is_dropped);
+        hints_.removeIf(is_dropped);
+    }
+}
+
+TicketView TicketStore::View(qsizetype index) const {
+    return {*this, index};
+}
+
+TicketStatus TicketStore::Status(qsizetype index) const {
+    return statuses_[index];
+}
+
+QString TicketStore::Name(qsizetype index) const {
+    auto it = names_.constFind(static_cast<int>(index));
+    return it == names_.cend() ? DefaultName(index) : it.value();
+}
+
+QString TicketStore::DefaultName(qsizetype index) {
+    return QString::fromUtf8(kDefaultNamePrefix.data(), kDefaultNamePrefix.size()) +
+           QString::number(index + 1);
+}
+
+bool TicketStore::IsDefaultName(QByteArrayView utf8, qsizetype index) {
+    std::string_view text(utf8.data(), utf8.size());
+    if (!text.starts_with(kDefaultNamePrefix)) {
+        return false;
+    }
+    std::array<char, 24> digits{};
+    auto [end, _] = std::to_chars(digits.data(), digits.data() + digits.size(), index + 1);
+    return text.substr(kDefaultNamePrefix.size()) == std::string_view(digits.data(), end);
+}
+
+bool TicketStore::HasCustomName(qsizetype index) const {
+    return names_.contains(static_cast<int>(index));
+}
+
+const QString& TicketStore::Hint(qsizetype index) const {
+    static const QString kNoHint;
+    auto it = hints_.constFind(static_cast<int>(index));
+    return it == hints_.cend() ? kNoHint : it.value();
+}
+
+void TicketStore::Rename(qsizetype index, const QString& new_name) {
+    names_.insert(static_cast<int>(index), new_name);
+}
+
+void TicketStore::ChangeStatus(qsizetype index, TicketStatus new_status) {
+    TicketStatus& status = statuses_[index];
+    --status_counts_[magic_enum::enum_index(status).value()];
+    ++status_counts_[magic_enum::enum_index(new_status).value()];
+    status = new_status;
+    scheduler_.SetStatus(index, new_status);
+}
+
+void TicketStore::SetHint(qsizetype index, const QString& hint) {
+    if (hint.isEmpty()) {
+        hints_.remove(static_cast<int>(index));
+    } else {
+        hints_.insert(static_cast<int>(index), hint);
+    }
+}
+
+const ReviewScheduler& TicketStore::Scheduler() const {
+    return scheduler_;
+}
+
+void TicketStore::MarkReviewed(qsizetype index) {
+    scheduler_.MarkReviewed(index);
+}
+
+qsizetype TicketStore::CountOf(TicketStatus status) const {
+    return status_counts_[magic_enum::enum_index(status).value()];
+}
+
+TicketView::TicketView(const TicketStore& store, qsizetype index) : store_(&store), index_(index) {
+}
+
+qsizetype TicketView::GetIndex() const {
+    return index_;
+}
+
+QString TicketView::GetName() const {
+    return store_->Name(index_);
+}
+
+TicketStatus TicketView::GetStatus() const {
+    return store_->Status(index_);
+}
+
+const QString& TicketView::GetHint() const {
+    return store_->Hint(index_);
+}
+
+QColor TicketView::GetStatusColor() const {
+    return StatusColor(GetStatus());
+}
@@ -0,0 +1,78 @@
+#ifndef TICKET_STORE_H
+#define TICKET_STORE_H
+
+#include "review_scheduler.h"
+#include "ticket.h"
+
+#include <QByteArrayView>
+#include <QHash>
+#include <QString>
+#include <array>
+#include <magic_enum/magic_enum.hpp>
+#include <vector>
+
+class TicketView;
+
+// Largest deck the app offers. Archives and imports asking for more are treated as corrupt.
+constexpr qsizetype kMaxTicketCount = 10'000'000;
+
+// Column-wise ticket storage: statuses live in a contiguous byte array so that
+// status-only queries never touch the name and hint pools.
+//
+// The ticket index is its position and is never stored. Names and hints are sparse: only renamed
+// tickets and tickets with a non-empty hint have an entry, so an untouched ticket costs its status
+// byte plus its review scheduler slot.
+class TicketStore {
+   public:
+    [[nodiscard]] qsizetype Size() const;
+    [[nodiscard]] bool IsEmpty() const;
+    void Clear();
+    void Append(QString name, TicketStatus status, QString hint);
+    // Appends default tickets or drops trailing ones; existing tickets are left untouched.
+    void Resize(qsizetype count);
+
+    [[nodiscard]] TicketView View(qsizetype index) const;
+    [[nodiscard]] TicketStatus Status(qsizetype index) const;
+    // Tickets that were never renamed get the default name, built on request.
+    [[nodiscard]] QString Name(qsizetype index) const;
+    [[nodiscard]] static QString DefaultName(qsizetype index);
+    // Whether the UTF-8 text spells DefaultName(index), checked without building the name.
+    [[nodiscard]] static bool IsDefaultName(QByteArrayView utf8, qsizetype index);
+    [[nodiscard]] bool HasCustomName(qsizetype index) const;
+    [[nodiscard]] const QString& Hint(qsizetype index) const;
+
+    void Rename(qsizetype index, const QString& new_name);
+    void ChangeStatus(qsizetype index, TicketStatus new_status);
+    void SetHint(qsizetype index, const QString& hint);
+
+    // Review weights follow status changes; MarkReviewed records that a ticket was shown.
+    [[nodiscard]] const ReviewScheduler& Scheduler() const;
+    void MarkReviewed(qsizetype index);
+    // Number of tickets with the given status, maintained by every mutation above.
+    [[nodiscard]] qsizetype CountOf(TicketStatus status) const;
+
+   private:
+    std::vector<TicketStatus> statuses_;
+    QHash<int, QString> names_;
+    QHash<int, QString> hints_;
+    ReviewScheduler scheduler_;
+    std::array<qsizetype, magic_enum::enum_count<TicketStatus>()> status_counts_{};
+};
+
+// Non-owning handle to a single ticket of a TicketStore. Reading fields through it does not
+// copy the underlying strings.
+class TicketView {
+   public:
+    TicketView(const TicketStore& store, qsizetype index);
+    [[nodiscard]] qsizetype GetIndex() const;
+    [[nodiscard]] QString GetName() const;
+    [[nodiscard]] TicketStatus GetStatus() const;
+    [[nodiscard]] const QString& GetHint() const;
+    [[nodiscard]] QColor GetStatusColor() const;
+
+   private:
+    const TicketStore* store_;
+    qsizetype index_;
+};
+
+#endif
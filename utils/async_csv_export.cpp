@@ -0,0 +1,93 @@
+#include "async_csv_export.h"
+
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+#include <QUuid>
+#include <utility>
+
+namespace {
+
+constexpr qint64 kProgressIntervalMs = 250;
+
+}  // namespace
+
+outfit::utils::csv::AsyncCsvExport::AsyncCsvExport(
+    QString connection_name, QString sql, QString header, QString file_name, QObject* parent)
+    : QObject(parent)
+    , connection_name_(std::move(connection_name))
+    , sql_(std::move(sql))
+    , header_(std::move(header))
+    , file_name_(std::move(file_name)) {
+}
+
+outfit::utils::csv::AsyncCsvExport::~AsyncCsvExport() {
+    if (thread_) {
+        Cancel();
+        thread_->wait();
+    }
+}
+
+void outfit::utils::csv::AsyncCsvExport::Start() {
+    if (IsRunning()) {
+        return;
+    }
+    canceled_ = false;
+    thread_.reset(QThread::create([this] { Run(); }));
+    thread_->start();
+}
+
+void outfit::utils::csv::AsyncCsvExport::Cancel() {
+    canceled_ = true;
+}
+
+bool outfit::utils::csv::AsyncCsvExport::IsRunning() const {
+    return thread_ && thread_->isRunning();
+}
+
+void outfit::utils::csv::AsyncCsvExport::Run() {
+    const QString clone_name = "csv-export-" + QUuid::createUuid().toString(QUuid::WithoutBraces);
+    ExportResult result;
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(connection_name_, clone_name);
+        QSaveFile csv_file(file_name_);
+        if (!db.open()) {
+            result = {ExportStatus::ConnectionFailed, 0, db.lastError().text()};
+        } else if (!csv_file.open(QIODevice::WriteOnly)) {
+            result = {ExportStatus::WriteFailed, 0, csv_file.errorString()};
+        } else {
+            QSqlQuery query(db);
+            query.prepare(sql_);
+            QElapsedTimer clock;
+            clock.start();
+            qint64 last_report = 0;
+            ExportOptions options;
+            options.cancel = &canceled_;
+            options.streaming = true;
+            options.gzip = file_name_.endsWith(".gz");
+            options.on_progress = [&](qint64 rows) {
+                qint64 elapsed = clock.elapsed();
+                if (elapsed - last_report >= kProgressIntervalMs) {
+                    last_report = elapsed;
+                    emit Progress(
+                        rows, 1000.0 * static_cast<double>(rows) / static_cast<double>(elapsed));
+                }
+            };
+            result = ExportQuery(query, &csv_file, header_, options);
+        }
+        if (result.IsOk() && canceled_) {
+            result.status = ExportStatus::Canceled;
+        }
+        if (result.IsOk() && !csv_file.commit()) {
+            result = {ExportStatus::WriteFailed, result.rows, csv_file.errorString()};
+        }
+        if (!result.IsOk()) {
+            csv_file.cancelWriting();
+        }
+    }
+    QSqlDatabase::removeDatabase(clone_name);
+    emit Finished(result);
+}
@@ -0,0 +1,54 @@
+#ifndef CREATIVE_ASYNC_CSV_EXPORT_H
+#define CREATIVE_ASYNC_CSV_EXPORT_H
+
+#include "csv_export.h"
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QThread;
+QT_END_NAMESPACE
+
+namespace outfit::utils::csv {
+// Runs a query on a worker thread and streams its rows into a CSV file. The worker opens its own
+// clone of the named connection, so the caller's connection stays usable while the export runs.
+// Connections that cannot be cloned (in-memory SQLite, for one) are not supported.
+//
+// Signals are emitted from the worker and therefore arrive queued on the object's thread. The
+// file is written through QSaveFile and only replaces the target when the export succeeds; a file
+// name ending in .gz is gzip-compressed on the fly.
+class AsyncCsvExport : public QObject {  // NOLINT
+    Q_OBJECT
+
+   public:
+    AsyncCsvExport(
+        QString connection_name, QString sql, QString header, QString file_name,
+        QObject* parent = nullptr);
+    // Cancels a running export and waits for the worker to stop.
+    ~AsyncCsvExport() override;
+
+    void Start();
+    // Safe to call from any thread; the worker notices within a few rows.
+    void Cancel();
+    [[nodiscard]] bool IsRunning() const;
+
+   signals:
+    void Progress(qint64 rows, double rows_per_second);
+    void Finished(const outfit::utils::csv::ExportResult& result);
+
+   private:
+    void Run();
+
+    QString connection_name_;
+    QString sql_;
+    QString header_;
+    QString file_name_;
+    std::unique_ptr<QThread> thread_;
+    std::atomic<bool> canceled_ = false;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_ASYNC_CSV_EXPORT_H
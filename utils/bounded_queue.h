@@ -0,0 +1,82 @@
+#ifndef CREATIVE_BOUNDED_QUEUE_H
+#define CREATIVE_BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace outfit::utils {
+// Fixed-capacity multi-producer, multi-consumer queue. Push blocks while the queue is full and Pop
+// blocks while it is empty, so a fast producer is throttled to the speed of its consumer. Close
+// wakes everyone up: further pushes fail, and pops drain what is left before failing.
+template <class T>
+class BoundedQueue {
+   public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {
+    }
+
+    bool Push(T value) {
+        std::unique_lock lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Never blocks; returns false when the queue is full or closed.
+    bool TryPush(T value) {
+        std::lock_guard lock(mutex_);
+        if (closed_ || items_.size() >= capacity_) {
+            return false;
+        }
+        items_.push_back(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    std::optional<T> Pop() {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        return TakeFront();
+    }
+
+    // Never blocks; returns nothing when the queue is empty.
+    std::optional<T> TryPop() {
+        std::lock_guard lock(mutex_);
+        return TakeFront();
+    }
+
+    void Close() {
+        std::lock_guard lock(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+   private:
+    std::optional<T> TakeFront() {
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(items_.front()));
+        items_.pop_front();
+        not_full_.notify_one();
+        return value;
+    }
+
+    const size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    bool closed_ = false;
+};
+}  // namespace outfit::utils
+
+#endif  // CREATIVE_BOUNDED_QUEUE_H
@@ -0,0 +1,326 @@
+#include "columnar_export.h"
+
+#include <QIODevice>
+#include <QMetaType>
+#include <QSqlError>
+#include <QSqlField>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QStringEncoder>
+#include <QVariant>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "the columnar format is written in host order");
+
+namespace {
+
+using outfit::utils::columnar::BatchHeader;
+using outfit::utils::columnar::ColumnType;
+using outfit::utils::csv::ExportResult;
+using outfit::utils::csv::ExportStatus;
+
+constexpr qint64 kAlignment = 8;
+constexpr qint64 kPollInterval = 1024;
+// A batch is cut early once one of its text columns holds this many bytes, keeping the int32
+// offsets clear of overflow.
+constexpr qsizetype kMaxBatchText = qsizetype{1} << 30;
+
+qint64 Padding(qint64 size) {
+    return (kAlignment - size % kAlignment) % kAlignment;
+}
+
+ColumnType TypeOf(int type_id) {
+    switch (type_id) {
+        case QMetaType::Int:
+        case QMetaType::Long:
+        case QMetaType::LongLong:
+        case QMetaType::Short:
+        case QMetaType::SChar:
+        case QMetaType::Bool:
+            return ColumnType::Int64;
+        case QMetaType::UInt:
+        case QMetaType::ULong:
+        case QMetaType::ULongLong:
+        case QMetaType::UShort:
+        case QMetaType::UChar:
+            return ColumnType::UInt64;
+        case QMetaType::Double:
+        case QMetaType::Float:
+            return ColumnType::Float64;
+        default:
+            return ColumnType::Utf8;
+    }
+}
+
+// One column of the batch being built. Buffers keep their capacity between batches.
+class ColumnBuilder {
+   public:
+    explicit ColumnBuilder(ColumnType type) : type_(type), encoder_(QStringEncoder::Utf8) {
+    }
+
+    // Returns false for a value the column cannot hold. Dynamically typed drivers such as SQLite
+    // may return text or reals in a column declared as integer, and a single text value may
+    // exceed what int32 offsets can address.
+    [[nodiscard]] bool Append(const QVariant& value) {
+        if (!value.isNull() && !Fits(value)) {
+            return false;
+        }
+        const qint64 row = rows_++;
+        if (static_cast<size_t>(row / 8) == validity_.size()) {
+            validity_.push_back(0);
+        }
+        const bool valid = !value.isNull();
+        if (valid) {
+            validity_.back() |= static_cast<uint8_t>(1U << (row % 8));
+        }
+        switch (type_) {
+            case ColumnType::Int64:
+                values_.push_back(valid ? value.toLongLong() : 0);
+                break;
+            case ColumnType::UInt64:
+                values_.push_back(valid ? static_cast<qint64>(value.toULongLong()) : 0);
+                break;
+            case ColumnType::Float64: {
+                double real = valid ? value.toDouble() : 0.0;
+                qint64 bits = 0;
+                std::memcpy(&bits, &real, sizeof(bits));
+                values_.push_back(bits);
+                break;
+            }
+            case ColumnType::Utf8:
+                if (valid) {
+                    AppendText(value.toString());
+                }
+                if (text_.size() > std::numeric_limits<qint32>::max()) {
+                    return false;
+                }
+                offsets_.push_back(static_cast<qint32>(text_.size()));
+                break;
+        }
+        return true;
+    }
+
+    // Appends {offset, length} entries for this column's buffers to `table`, and the buffers,
+    // each padded to the alignment, to `body`.
+    void Finish(std::vector<qint64>* table, QByteArray* body) const {
+        AppendBuffer(validity_.data(), static_cast<qint64>(validity_.size()), table, body);
+        if (type_ == ColumnType::Utf8) {
+            AppendBuffer(
+                offsets_.data(), static_cast<qint64>(offsets_.size() * sizeof(qint32)), table,
+                body);
+            AppendBuffer(text_.constData(), text_.size(), table, body);
+        } else {
+            AppendBuffer(
+                values_.data(), static_cast<qint64>(values_.size() * sizeof(qint64)), table, body);
+        }
+    }
+
+    [[nodiscard]] qsizetype TextSize() const {
+        return text_.size();
+    }
+
+    [[nodiscard]] qsizetype BufferCount() const {
+        return type_ == ColumnType::Utf8 ? 3 : 2;
+    }
+
+    void Clear() {
+        rows_ = 0;
+        validity_.clear();
+        values_.clear();
+        offsets_.assign(1, 0);
+        text_.resize(0);
+    }
+
+   private:
+    // Integers of the other signedness are accepted while they stay in range, and any number
+    // goes into a real column; text columns take everything.
+    [[nodiscard]] bool Fits(const QVariant& value) const {
+        const ColumnType value_type = TypeOf(value.metaType().id());
+        switch (type_) {
+            case ColumnType::Int64:
+                return value_type == ColumnType::Int64 ||
+                       (value_type == ColumnType::UInt64 &&
+                        value.toULongLong() <= std::numeric_limits<qint64>::max());
+            case ColumnType::UInt64:
+                return value_type == ColumnType::UInt64 ||
+                       (value_type == ColumnType::Int64 && value.toLongLong() >= 0);
+            case ColumnType::Float64:
+                return value_type != ColumnType::Utf8;
+            case ColumnType::Utf8:
+                return true;
+        }
+        return false;
+    }
+
+    void AppendText(const QString& text) {
+        qsizetype begin = text_.size();
+        text_.resize(begin + encoder_.requiredSpace(text.size()));
+        char* end = encoder_.appendToBuffer(text_.data() + begin, text);
+        text_.truncate(end - text_.constData());
+    }
+
+    static void AppendBuffer(
+        const void* data, qint64 size, std::vector<qint64>* table, QByteArray* body) {
+        table->push_back(body->size());
+        table->push_back(size);
+        body->append(static_cast<const char*>(data), size);
+        body->append(Padding(size), '\0');
+    }
+
+    ColumnType type_;
+    QStringEncoder encoder_;
+    qint64 rows_ = 0;
+    std::vector<uint8_t> validity_;
+    std::vector<qint64> values_;
+    std::vector<qint32> offsets_ = {0};
+    QByteArray text_;
+};
+
+// Writes to the device while tracking the file offset, which sequential devices cannot report.
+class Output {
+   public:
+    explicit Output(QIODevice* device) : device_(device) {
+    }
+
+    bool Write(const void* data, qint64 size) {
+        if (device_->write(static_cast<const char*>(data), size) != size) {
+            return false;
+        }
+        position_ += size;
+        return true;
+    }
+
+    template <class T>
+    bool WriteValue(const T& value) {
+        return Write(&value, sizeof(value));
+    }
+
+    bool Pad() {
+        static constexpr char kZeros[kAlignment] = {};
+        return Write(kZeros, Padding(position_));
+    }
+
+    [[nodiscard]] qint64 Position() const {
+        return position_;
+    }
+
+   private:
+    QIODevice* device_;
+    qint64 position_ = 0;
+};
+
+bool WriteSchema(Output* out, const QSqlRecord& record, std::vector<ColumnBuilder>* columns) {
+    outfit::utils::columnar::FileHeader header;
+    header.column_count = static_cast<quint16>(record.count());
+    if (!out->WriteValue(header)) {
+        return false;
+    }
+    for (int i = 0; i < record.count(); ++i) {
+        const QSqlField field = record.field(i);
+        const ColumnType type = TypeOf(field.metaType().id());
+        columns->emplace_back(type);
+        const QByteArray name = field.name().toUtf8();
+        const quint8 type_and_reserved[4] = {static_cast<quint8>(type), 0, 0, 0};
+        if (!out->Write(type_and_reserved, sizeof(type_and_reserved)) ||
+            !out->WriteValue(static_cast<quint32>(name.size())) ||
+            !out->Write(name.constData(), name.size()) || !out->Pad()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WriteBatch(
+    Output* out, std::vector<ColumnBuilder>* columns, qint64 rows, std::vector<qint64>* table,
+    QByteArray* body, std::vector<quint64>* batches) {
+    table->clear();
+    body->resize(0);
+    for (const ColumnBuilder& column : *columns) {
+        column.Finish(table, body);
+    }
+    BatchHeader header;
+    header.row_count = rows;
+    header.length = static_cast<qint64>(table->size() * sizeof(qint64)) + body->size();
+    batches->push_back(out->Position());
+    if (!out->WriteValue(header) ||
+        !out->Write(table->data(), static_cast<qint64>(table->size() * sizeof(qint64))) ||
+        !out->Write(body->constData(), body->size())) {
+        return false;
+    }
+    for (ColumnBuilder& column : *columns) {
+        column.Clear();
+    }
+    return true;
+}
+
+bool TextFull(const std::vector<ColumnBuilder>& columns) {
+    return std::ranges::any_of(
+        columns, [](const ColumnBuilder& column) { return column.TextSize() >= kMaxBatchText; });
+}
+
+bool WriteFooter(Output* out, const std::vector<quint64>& batches) {
+    const qint64 footer = out->Position();
+    return out->WriteValue(static_cast<quint64>(batches.size())) &&
+           out->Write(batches.data(), static_cast<qint64>(batches.size() * sizeof(quint64))) &&
+           out->WriteValue(static_cast<quint64>(footer)) &&
+           out->WriteValue(outfit::utils::columnar::kMagic);
+}
+
+}  // namespace
+
+outfit::utils::csv::ExportResult outfit::utils::columnar::ExportQuery(
+    QSqlQuery& query, QIODevice* device, const csv::ExportOptions& options, qsizetype batch_rows) {
+    ExportResult result;
+    query.setForwardOnly(true);
+    if (!query.exec()) {
+        return {ExportStatus::QueryFailed, 0, query.lastError().text()};
+    }
+    Output out(device);
+    std::vector<ColumnBuilder> columns;
+    const QSqlRecord record = query.record();
+    if (!WriteSchema(&out, record, &columns)) {
+        return {ExportStatus::WriteFailed, 0, device->errorString()};
+    }
+    const int column_count = record.count();
+    std::vector<qint64> table;
+    QByteArray body;
+    std::vector<quint64> batches;
+    qint64 batch_size = 0;
+    bool written = true;
+    while (written && query.next()) {
+        for (int i = 0; i < column_count; ++i) {
+            if (!columns[i].Append(query.value(i))) {
+                const QString error = "row %1: the value of column %2 does not fit its type";
+                return {
+                    ExportStatus::QueryFailed, result.rows,
+                    error.arg(result.rows + 1).arg(record.fieldName(i))};
+            }
+        }
+        ++result.rows;
+        if (++batch_size == batch_rows || TextFull(columns)) {
+            written = WriteBatch(&out, &columns, batch_size, &table, &body, &batches);
+            batch_size = 0;
+        }
+        if (result.rows % kPollInterval != 0) {
+            continue;
+        }
+        if (options.cancel != nullptr && options.cancel->load(std::memory_order_relaxed)) {
+            result.status = ExportStatus::Canceled;
+            return result;
+        }
+        if (options.on_progress) {
+            options.on_progress(result.rows);
+        }
+    }
+    if (written && batch_size > 0) {
+        written = WriteBatch(&out, &columns, batch_size, &table, &body, &batches);
+    }
+    if (!written || !WriteFooter(&out, batches)) {
+        result.status = ExportStatus::WriteFailed;
+        result.error = device->errorString();
+    }
+    return result;
+}
@@ -0,0 +1,56 @@
+#ifndef CREATIVE_COLUMNAR_EXPORT_H
+#define CREATIVE_COLUMNAR_EXPORT_H
+
+#include "csv_export.h"
+
+#include <QtGlobal>
+#include <cstdint>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+class QSqlQuery;
+QT_END_NAMESPACE
+
+// Binary columnar export: rows are gathered into record batches of typed column vectors, laid
+// out like Arrow buffers so a reader can mmap the file and use the columns in place.
+//
+// All integers are little-endian and every buffer starts on an 8-byte boundary.
+//
+//   file    := FileHeader schema batch* footer
+//   schema  := per column: u8 ColumnType, u8[3] reserved, u32 name length, UTF-8 name, padding
+//   batch   := BatchHeader, then per column its buffers, each as {i64 offset, i64 length}
+//              relative to the batch body, then the body itself
+//   footer  := u64 batch count, u64 file offset of every batch, u64 footer offset, u32 magic
+//
+// Every column has a validity bitmap (bit i set when row i is not NULL, least significant bit
+// first) followed by 8-byte values for numeric types, or by row_count + 1 int32 offsets and the
+// concatenated UTF-8 bytes for text.
+namespace outfit::utils::columnar {
+constexpr quint32 kMagic = 0x4C4F'434F;  // "OCOL"
+constexpr quint16 kVersion = 1;
+constexpr qsizetype kDefaultBatchRows = 64 * 1024;
+
+enum class ColumnType : uint8_t { Int64, UInt64, Float64, Utf8 };
+
+struct FileHeader {
+    quint32 magic = kMagic;
+    quint16 version = kVersion;
+    quint16 column_count = 0;
+};
+
+struct BatchHeader {
+    qint64 row_count = 0;
+    // Total size of the buffer table and body that follow.
+    qint64 length = 0;
+};
+
+// Writes the result of the prepared query as one columnar file. Only the cancel flag and progress
+// callback of the options apply. A batch also ends early once a text column holds 1 GiB. A value
+// that does not fit its column's type, such as text in an integer column, fails the export with
+// ExportStatus::QueryFailed.
+csv::ExportResult ExportQuery(
+    QSqlQuery& query, QIODevice* device, const csv::ExportOptions& options = {},
+    qsizetype batch_rows = kDefaultBatchRows);
+}  // namespace outfit::utils::columnar
+
+#endif  // CREATIVE_COLUMNAR_EXPORT_H
@@ -6,52 +6,82 @@
 
 #include <QFile>
 #include <QFileDialog>
-#include <QLatin1Char>
 #include <QMessageBox>
+#include <QPointer>
+#include <QProgressDialog>
 #include <QSqlQuery>
-#include <QSqlRecord>
 #include <QString>
-#include <QStringLiteral>
-#include <QTextStream>
-#include <QtCore/qstringconverter_base.h>
 
-QString outfit::utils::csv::EscapeCSV(QString unexc) {
-    if (!unexc.contains(QLatin1Char(','))) {
-        return unexc;
+namespace {
+
+constexpr char kFileFilter[] = "CSV (*.csv);;Gzip-compressed CSV (*.csv.gz)";
+
+QString StatusMessage(outfit::utils::csv::ExportStatus status) {
+    using outfit::utils::csv::ExportStatus;
+    switch (status) {
+        case ExportStatus::ConnectionFailed:
+            return "failed to open database connection";
+        case ExportStatus::QueryFailed:
+            return "failed to run query";
+        case ExportStatus::WriteFailed:
+            return "failed to write file";
+        default:
+            return {};
     }
-    return '\"' + unexc.replace(QLatin1Char('\"'), QStringLiteral("\"\"")) + '\"';
 }
 
+}  // namespace
+
 void outfit::utils::csv::SaveQuery(const QString& header, QSqlQuery& query) {
-    const QString file_name =
-        QFileDialog::getSaveFileName(nullptr, "export.csv", ".", "CSV (*.csv)");
+    const QString file_name = QFileDialog::getSaveFileName(nullptr, "export.csv", ".", kFileFilter);
     if (file_name == "") {
         return;
     }
+    ExportOptions options;
+    options.gzip = file_name.endsWith(".gz");
     QFile csv_file(file_name);
-    if (!csv_file.open(QFile::WriteOnly | QFile::Text)) {
+    if (!csv_file.open(options.gzip ? QFile::WriteOnly : QFile::WriteOnly | QFile::Text)) {
         QMessageBox msg;
         msg.setText("failed to open file");
         msg.exec();
         return;
     }
-    if (!query.exec()) {
+    const ExportResult result = ExportQuery(query, &csv_file, header, options);
+    if (!result.IsOk()) {
         QMessageBox msg;
-        msg.setText("failed to run query");
+        msg.setText(StatusMessage(result.status));
         msg.exec();
+    }
+}
+
+void outfit::utils::csv::SaveQueryAsync(
+    QWidget* parent, const QString& header, const QString& connection_name, const QString& sql) {
+    const QString file_name = QFileDialog::getSaveFileName(parent, "export.csv", ".", kFileFilter);
+    if (file_name == "") {
         return;
     }
-    QTextStream out_stream(&csv_file);
-    out_stream << header << "\n";
-    out_stream.setEncoding(QStringConverter::Utf8);
-    while (query.next()) {
-        const QSqlRecord record = query.record();
-        for (int i = 0, rec_count = record.count(); i < rec_count; ++i) {
-            if (i > 0) {
-                out_stream << ',';
+    auto* task = new AsyncCsvExport(connection_name, sql, header, file_name, parent);
+    // Closing the dialog deletes it while the export may still be running, hence the QPointer.
+    QPointer<QProgressDialog> progress =
+        new QProgressDialog("Exporting...", "Cancel", 0, 0, parent);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setMinimumDuration(500);
+    QObject::connect(progress, &QProgressDialog::canceled, task, &AsyncCsvExport::Cancel);
+    QObject::connect(
+        task, &AsyncCsvExport::Progress, progress, [progress](qint64 rows, double rows_per_second) {
+            progress->setLabelText(
+                QString("Exported %1 rows (%2 rows/s)").arg(rows).arg(rows_per_second, 0, 'f', 0));
+        });
+    QObject::connect(
+        task, &AsyncCsvExport::Finished, task,
+        [task, progress, parent](const ExportResult& result) {
+            if (progress) {
+                progress->close();
             }
-            out_stream << utils::csv::EscapeCSV(record.value(i).toString());
-        }
-        out_stream << '\n';
-    }
+            if (!result.IsOk() && result.status != ExportStatus::Canceled) {
+                QMessageBox::warning(parent, "export.csv", StatusMessage(result.status));
+            }
+            task->deleteLater();
+        });
+    task->Start();
 }
\ No newline at end of file
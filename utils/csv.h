@@ -5,13 +5,24 @@
 #ifndef CREATIVE_CSV_H
 #define CREATIVE_CSV_H
 
+#include "async_csv_export.h"
+#include "csv_export.h"
+
 #include <QSqlQuery>
 #include <QString>
 
-namespace outfit::utils::csv {
-QString EscapeCSV(QString unexc);
+QT_BEGIN_NAMESPACE
+class QWidget;
+QT_END_NAMESPACE
 
+namespace outfit::utils::csv {
+// Asks for a file name and exports the query into it, reporting failures with a message box.
 void SaveQuery(const QString& header, QSqlQuery& query);
+
+// Asks for a file name, then exports in the background behind a progress dialog with a cancel
+// button. Errors are reported with a message box; the export object deletes itself when done.
+void SaveQueryAsync(
+    QWidget* parent, const QString& header, const QString& connection_name, const QString& sql);
 }  // namespace outfit::utils::csv
 
 #endif  // CREATIVE_CSV_H
@@ -0,0 +1,181 @@
+#include "csv_export.h"
+#include "tools/util/util.h"
+
+#include <QCoreApplication>
+#include <QIODevice>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantList>
+#include <benchmark/benchmark.h>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+constexpr size_t kFieldCount = 10'000;
+constexpr size_t kFieldLength = 24;
+constexpr qint64 kTableRows = 1'000'000;
+constexpr char kConnection[] = "csv-benchmark";
+
+// Share of fields, in percent, that get a comma and a quote respectively.
+struct FieldMix {
+    int commas;
+    int quotes;
+};
+
+constexpr FieldMix kMixes[] = {
+    {.commas = 1, .quotes = 0},    // Mostly clean text.
+    {.commas = 50, .quotes = 0},   // Many separators.
+    {.commas = 50, .quotes = 50},  // Heavy quoting.
+};
+
+QStringList MakeFields(const FieldMix& mix) {
+    RandomGenerator generator;
+    const std::vector<int> dice = generator.GenIntegralVector<int>(2 * kFieldCount, 0, 99);
+    QStringList fields;
+    fields.reserve(kFieldCount);
+    for (size_t i = 0; i < kFieldCount; ++i) {
+        QString field = QString::fromStdString(generator.GenString(kFieldLength));
+        if (dice[2 * i] < mix.commas) {
+            field[kFieldLength / 3] = QLatin1Char(',');
+        }
+        if (dice[2 * i + 1] < mix.quotes) {
+            field[2 * kFieldLength / 3] = QLatin1Char('"');
+        }
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+void BM_EscapeCSV(benchmark::State& state) {
+    const QStringList fields = MakeFields(kMixes[state.range(0)]);
+    for (auto _ : state) {
+        for (const QString& field : fields) {
+            benchmark::DoNotOptimize(outfit::utils::csv::EscapeCSV(field));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(fields.size()));
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<int64_t>(fields.size()) *
+        static_cast<int64_t>(kFieldLength));
+}
+BENCHMARK(BM_EscapeCSV)->DenseRange(0, std::size(kMixes) - 1)->ArgName("mix");
+
+// Fills an in-memory SQLite table with an integer, a real and a text column. Returns the driver's
+// message if any step failed, or an empty string.
+QString FillTable() {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+    db.setDatabaseName(":memory:");
+    if (!db.open()) {
+        return db.lastError().text();
+    }
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TABLE items (id INTEGER PRIMARY KEY, price REAL, name TEXT)")) {
+        return query.lastError().text();
+    }
+    RandomGenerator generator;
+    const std::vector<double> prices = generator.GenRealVector(kTableRows, 0.0, 1000.0);
+    QVariantList ids;
+    QVariantList price_values;
+    QVariantList names;
+    for (qint64 i = 0; i < kTableRows; ++i) {
+        ids.push_back(i);
+        price_values.push_back(prices[i]);
+        names.push_back(QString::fromStdString(generator.GenString(kFieldLength)));
+    }
+    if (!db.transaction()) {
+        return db.lastError().text();
+    }
+    if (!query.prepare("INSERT INTO items VALUES (?, ?, ?)")) {
+        return query.lastError().text();
+    }
+    query.addBindValue(ids);
+    query.addBindValue(price_values);
+    query.addBindValue(names);
+    if (!query.execBatch()) {
+        return query.lastError().text();
+    }
+    if (!db.commit()) {
+        return db.lastError().text();
+    }
+    return {};
+}
+
+// Discards what is written to it but counts the bytes. /dev/null is sequential, so its pos()
+// stays 0 however much is written.
+class CountingSink : public QIODevice {
+   public:
+    CountingSink() {
+        open(WriteOnly | Unbuffered);
+    }
+
+    [[nodiscard]] bool isSequential() const override {
+        return true;
+    }
+
+    [[nodiscard]] qint64 Count() const {
+        return count_;
+    }
+
+   protected:
+    qint64 readData(char*, qint64) override {
+        return -1;
+    }
+
+    qint64 writeData(const char*, qint64 size) override {
+        count_ += size;
+        return size;
+    }
+
+   private:
+    qint64 count_ = 0;
+};
+
+void BM_ExportQuery(benchmark::State& state) {
+    // Filled once per process, before the first run.
+    static const QString setup_error = FillTable();
+    if (!setup_error.isEmpty()) {
+        state.SkipWithError("table setup failed: " + setup_error.toStdString());
+        return;
+    }
+    QSqlDatabase db = QSqlDatabase::database(kConnection);
+    outfit::utils::csv::ExportOptions options;
+    options.streaming = state.range(0) != 0;
+    qint64 bytes = 0;
+    qint64 rows = 0;
+    for (auto _ : state) {
+        CountingSink sink;
+        QSqlQuery query(db);
+        query.prepare("SELECT id, price, name FROM items");
+        const outfit::utils::csv::ExportResult result =
+            outfit::utils::csv::ExportQuery(query, &sink, "id,price,name", options);
+        if (!result.IsOk()) {
+            state.SkipWithError(result.error.toStdString());
+            break;
+        }
+        rows += result.rows;
+        bytes += sink.Count();
+    }
+    state.SetItemsProcessed(rows);
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ExportQuery)->Arg(0)->Arg(1)->ArgName("streaming")->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // The SQLite driver is a plugin, which needs an application object to be found.
+    QCoreApplication app(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    QSqlDatabase::removeDatabase(kConnection);
+    return 0;
+}
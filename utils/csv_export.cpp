@@ -0,0 +1,591 @@
+#include "csv_export.h"
+
+#include "bounded_queue.h"
+#include "csv_scan.h"
+#include "gzip_device.h"
+#include "tools/util/util.h"
+
+#include <QFile>
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLatin1Char>
+#include <QMetaType>
+#include <QSqlError>
+#include <QSqlField>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QString>
+#include <QVariant>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Rows between checks of the cancel flag and calls to the progress callback.
+constexpr qint64 kPollInterval = 1024;
+// Rows handed from the fetching thread to the formatting thread at a time, and the number of
+// such batches that may wait in the queue.
+constexpr qsizetype kBatchRows = 1024;
+constexpr size_t kQueueDepth = 4;
+
+// Clock for the sampled phases. A Timer also reads the process CPU time, a system call that
+// costs more than formatting the field it would measure; it is kept for the export totals.
+using Clock = std::chrono::steady_clock;
+
+struct RowBatch {
+    std::vector<QVariant> values;
+    qsizetype rows = 0;
+};
+
+// How a column's values are formatted, decided once per column from the field's type.
+enum class ColumnKind : uint8_t { Text, Signed, Unsigned, Real };
+
+struct Column {
+    int type_id = QMetaType::UnknownType;
+    ColumnKind kind = ColumnKind::Text;
+};
+
+ColumnKind KindOf(int type_id) {
+    switch (type_id) {
+        case QMetaType::Int:
+        case QMetaType::Long:
+        case QMetaType::LongLong:
+        case QMetaType::Short:
+        case QMetaType::SChar:
+            return ColumnKind::Signed;
+        case QMetaType::UInt:
+        case QMetaType::ULong:
+        case QMetaType::ULongLong:
+        case QMetaType::UShort:
+        case QMetaType::UChar:
+            return ColumnKind::Unsigned;
+        case QMetaType::Double:
+            return ColumnKind::Real;
+        default:
+            return ColumnKind::Text;
+    }
+}
+
+std::vector<Column> Columns(const QSqlRecord& record) {
+    std::vector<Column> columns(record.count());
+    for (int i = 0; i < record.count(); ++i) {
+        columns[i].type_id = record.field(i).metaType().id();
+        columns[i].kind = KindOf(columns[i].type_id);
+    }
+    return columns;
+}
+
+void WriteValue(
+    outfit::utils::csv::CsvWriter& writer, const QVariant& value, const Column& column) {
+    if (value.isNull()) {
+        writer.WriteField(QByteArrayView());
+        return;
+    }
+    // Dynamically typed drivers such as SQLite may hand out values of another type than the
+    // column declares; those are classified one by one.
+    const int type_id = value.metaType().id();
+    switch (type_id == column.type_id ? column.kind : KindOf(type_id)) {
+        case ColumnKind::Signed:
+            writer.WriteInteger(value.toLongLong());
+            break;
+        case ColumnKind::Unsigned:
+            writer.WriteUnsigned(value.toULongLong());
+            break;
+        case ColumnKind::Real:
+            writer.WriteReal(value.toDouble());
+            break;
+        case ColumnKind::Text:
+            writer.WriteField(value.toString());
+            break;
+    }
+}
+
+std::chrono::nanoseconds Since(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+}
+
+// Returns the stats to time the given row into, or null for rows outside the sample.
+outfit::utils::csv::ExportStats* Sample(outfit::utils::csv::ExportStats* stats, qint64 row) {
+    return stats != nullptr && row % outfit::utils::csv::ExportStats::kStatsSampleInterval == 0
+               ? stats
+               : nullptr;
+}
+
+bool Fetch(QSqlQuery& query, outfit::utils::csv::ExportStats* sample) {
+    if (sample == nullptr) {
+        return query.next();
+    }
+    const Clock::time_point start = Clock::now();
+    bool fetched = query.next();
+    sample->fetch += Since(start);
+    return fetched;
+}
+
+// Writes one row, taking the i-th value from value(i). For sampled rows the formatting time is
+// recorded apart from the escaping the writer times on its own.
+template <class Value>
+void WriteRow(
+    outfit::utils::csv::CsvWriter& writer, const std::vector<Column>& columns, Value&& value,
+    outfit::utils::csv::ExportStats* sample) {
+    const int column_count = static_cast<int>(columns.size());
+    if (sample == nullptr) {
+        for (int i = 0; i < column_count; ++i) {
+            WriteValue(writer, value(i), columns[i]);
+        }
+    } else {
+        const std::chrono::nanoseconds escape_before = sample->escape;
+        writer.TimeEscaping(&sample->escape);
+        const Clock::time_point start = Clock::now();
+        for (int i = 0; i < column_count; ++i) {
+            WriteValue(writer, value(i), columns[i]);
+        }
+        sample->format += Since(start) - (sample->escape - escape_before);
+        writer.TimeEscaping(nullptr);
+    }
+    writer.EndRow();
+}
+
+// Scales the sampled phases up and hands the stats to the sink.
+void Report(
+    const outfit::utils::csv::ExportOptions& options, outfit::utils::csv::ExportStats* stats,
+    const Timer& total, qint64 rows, qint64 bytes) {
+    constexpr qint64 kScale = outfit::utils::csv::ExportStats::kStatsSampleInterval;
+    stats->rows = rows;
+    stats->bytes = bytes;
+    stats->fetch *= kScale;
+    stats->format *= kScale;
+    stats->escape *= kScale;
+    const auto times = total.GetTimes();
+    stats->wall = std::chrono::duration_cast<std::chrono::nanoseconds>(times.wall_time);
+    stats->cpu = times.cpu_time;
+    options.on_stats(*stats);
+}
+
+// Reports progress; returns false once the export has been canceled.
+bool Poll(const outfit::utils::csv::ExportOptions& options, qint64 rows) {
+    if (options.cancel != nullptr && options.cancel->load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (options.on_progress) {
+        options.on_progress(rows);
+    }
+    return true;
+}
+
+outfit::utils::csv::ExportResult ExportStreaming(
+    QSqlQuery& query, const std::vector<Column>& columns, QIODevice* device, const QString& header,
+    const outfit::utils::csv::ExportOptions& options) {
+    using outfit::utils::csv::ExportStatus;
+    outfit::utils::BoundedQueue<RowBatch> filled(kQueueDepth);
+    // Formatted batches come back here so their storage is reused instead of reallocated.
+    outfit::utils::BoundedQueue<RowBatch> recycled(kQueueDepth + 1);
+    bool write_failed = false;
+    const Timer total;
+    // Each side times into its own stats; they are merged once both are done.
+    outfit::utils::csv::ExportStats fetch_stats;
+    outfit::utils::csv::ExportStats format_stats;
+    const bool timed = static_cast<bool>(options.on_stats);
+    qint64 bytes = 0;
+    std::thread formatter([&] {
+        outfit::utils::csv::CsvWriter writer(device);
+        if (timed) {
+            writer.TimeWrites(&format_stats.write);
+        }
+        if (!header.isEmpty()) {
+            writer.WriteRaw(header);
+            writer.EndRow();
+        }
+        qint64 formatted = 0;
+        while (std::optional<RowBatch> batch = filled.Pop()) {
+            const QVariant* values = batch->values.data();
+            for (qsizetype row = 0; row < batch->rows; ++row) {
+                WriteRow(
+                    writer, columns, [values](int i) -> const QVariant& { return values[i]; },
+                    Sample(timed ? &format_stats : nullptr, formatted++));
+                values += columns.size();
+            }
+            batch->values.clear();
+            batch->rows = 0;
+            recycled.TryPush(std::move(*batch));
+            if (writer.HasError()) {
+                break;
+            }
+        }
+        write_failed = !writer.Flush();
+        bytes = writer.BytesWritten();
+        // Unblocks the fetching side if formatting stopped early.
+        filled.Close();
+    });
+
+    outfit::utils::csv::ExportResult result;
+    const int column_count = static_cast<int>(columns.size());
+    RowBatch batch;
+    while (Fetch(query, Sample(timed ? &fetch_stats : nullptr, result.rows))) {
+        for (int i = 0; i < column_count; ++i) {
+            batch.values.push_back(query.value(i));
+        }
+        ++result.rows;
+        if (++batch.rows == kBatchRows) {
+            if (!filled.Push(std::move(batch))) {
+                break;
+            }
+            batch = recycled.TryPop().value_or(RowBatch{});
+        }
+        if (result.rows % kPollInterval == 0 && !Poll(options, result.rows)) {
+            result.status = ExportStatus::Canceled;
+            break;
+        }
+    }
+    if (batch.rows > 0 && result.status != ExportStatus::Canceled) {
+        filled.Push(std::move(batch));
+    }
+    filled.Close();
+    formatter.join();
+    if (write_failed) {
+        result.status = ExportStatus::WriteFailed;
+        result.error = device->errorString();
+    }
+    if (timed) {
+        format_stats.fetch = fetch_stats.fetch;
+        Report(options, &format_stats, total, result.rows, bytes);
+    }
+    return result;
+}
+
+}  // namespace
+
+QString outfit::utils::csv::EscapeCSV(const QString& unexc) {
+    const auto* begin = reinterpret_cast<const char16_t*>(unexc.utf16());
+    const char16_t* end = begin + unexc.size();
+    const char16_t* special = FindSpecial(begin, end);
+    if (special == end) {
+        return unexc;
+    }
+    const QStringView view(unexc);
+    QString escaped;
+    escaped.reserve(unexc.size() + view.sliced(special - begin).count(u'"') + 2);
+    escaped += QLatin1Char('"');
+    qsizetype run = 0;
+    for (qsizetype quote = view.indexOf(u'"', special - begin); quote != -1;
+         quote = view.indexOf(u'"', run)) {
+        escaped += view.sliced(run, quote - run + 1);
+        escaped += QLatin1Char('"');
+        run = quote + 1;
+    }
+    escaped += view.sliced(run);
+    escaped += QLatin1Char('"');
+    return escaped;
+}
+
+outfit::utils::csv::ExportResult outfit::utils::csv::ExportQuery(
+    QSqlQuery& query, QIODevice* device, const QString& header, const ExportOptions& options) {
+    if (options.gzip) {
+        GzipDevice gzip(device);
+        if (!gzip.open(QIODevice::WriteOnly)) {
+            return {ExportStatus::WriteFailed, 0, gzip.errorString()};
+        }
+        ExportOptions plain = options;
+        plain.gzip = false;
+        ExportResult result = ExportQuery(query, &gzip, header, plain);
+        gzip.close();
+        if (result.IsOk() && gzip.HasError()) {
+            result.status = ExportStatus::WriteFailed;
+            result.error = gzip.errorString();
+        }
+        return result;
+    }
+    ExportResult result;
+    if (options.streaming) {
+        query.setForwardOnly(true);
+    }
+    if (!query.exec()) {
+        result.status = ExportStatus::QueryFailed;
+        result.error = query.lastError().text();
+        return result;
+    }
+    const std::vector<Column> columns = Columns(query.record());
+    if (options.streaming) {
+        return ExportStreaming(query, columns, device, header, options);
+    }
+    const Timer total;
+    ExportStats stats;
+    ExportStats* timed = options.on_stats ? &stats : nullptr;
+    CsvWriter writer(device);
+    if (timed != nullptr) {
+        writer.TimeWrites(&stats.write);
+    }
+    if (!header.isEmpty()) {
+        writer.WriteRaw(header);
+        writer.EndRow();
+    }
+    while (Fetch(query, Sample(timed, result.rows))) {
+        WriteRow(
+            writer, columns, [&query](int i) { return query.value(i); },
+            Sample(timed, result.rows));
+        if (++result.rows % kPollInterval == 0 && !Poll(options, result.rows)) {
+            result.status = ExportStatus::Canceled;
+            break;
+        }
+    }
+    if (!writer.Flush() && result.IsOk()) {
+        result.status = ExportStatus::WriteFailed;
+        result.error = device->errorString();
+    }
+    if (timed != nullptr) {
+        Report(options, &stats, total, result.rows, writer.BytesWritten());
+    }
+    return result;
+}
+
+QByteArray outfit::utils::csv::ExportStats::ToJson() const {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    const double seconds = std::chrono::duration<double>(wall).count();
+    QJsonObject object;
+    object["rows"] = rows;
+    object["bytes"] = bytes;
+    object["wall_ms"] = Milliseconds(wall).count();
+    object["cpu_ms"] = Milliseconds(cpu).count();
+    object["fetch_ms"] = Milliseconds(fetch).count();
+    object["format_ms"] = Milliseconds(format).count();
+    object["escape_ms"] = Milliseconds(escape).count();
+    object["write_ms"] = Milliseconds(write).count();
+    object["rows_per_second"] = seconds > 0 ? static_cast<double>(rows) / seconds : 0.0;
+    object["bytes_per_second"] = seconds > 0 ? static_cast<double>(bytes) / seconds : 0.0;
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+outfit::utils::csv::ExportResult outfit::utils::csv::ExportQuery(
+    QSqlQuery& query, int fd, const QString& header, const ExportOptions& options) {
+    QFile file;
+    if (!file.open(fd, QIODevice::WriteOnly, QFileDevice::DontCloseHandle)) {
+        return {ExportStatus::WriteFailed, 0, file.errorString()};
+    }
+    ExportResult result = ExportQuery(query, &file, header, options);
+    if (result.IsOk() && !file.flush()) {
+        result.status = ExportStatus::WriteFailed;
+        result.error = file.errorString();
+    }
+    return result;
+}
+
+outfit::utils::csv::CsvReader::CsvReader(QIODevice* device, qsizetype buffer_size)
+    : device_(device), buffer_(buffer_size) {
+}
+
+bool outfit::utils::csv::CsvReader::ReadRow() {
+    row_.clear();
+    ends_.clear();
+    char c = 0;
+    if (!Next(&c)) {
+        return false;
+    }
+    if (skip_line_feed_) {
+        skip_line_feed_ = false;
+        if (c == '\n' && !Next(&c)) {
+            return false;
+        }
+    }
+    bool quoted = false;
+    while (true) {
+        if (quoted) {
+            if (c != '"') {
+                row_.push_back(c);
+            } else if (!Next(&c)) {
+                break;
+            } else if (c == '"') {
+                row_.push_back('"');
+            } else {
+                // Closing quote: handle the character after it as unquoted input.
+                quoted = false;
+                continue;
+            }
+        } else if (c == ',') {
+            ends_.push_back(static_cast<qsizetype>(row_.size()));
+        } else if (c == '\n') {
+            break;
+        } else if (c == '\r') {
+            skip_line_feed_ = true;
+            break;
+        } else if (c == '"' && static_cast<qsizetype>(row_.size()) ==
+                                   (ends_.empty() ? 0 : ends_.back())) {
+            quoted = true;
+        } else {
+            row_.push_back(c);
+        }
+        if (!Next(&c)) {
+            error_ = error_ || quoted;
+            break;
+        }
+    }
+    ends_.push_back(static_cast<qsizetype>(row_.size()));
+    return true;
+}
+
+qsizetype outfit::utils::csv::CsvReader::FieldCount() const {
+    return static_cast<qsizetype>(ends_.size());
+}
+
+QByteArrayView outfit::utils::csv::CsvReader::Field(qsizetype index) const {
+    qsizetype begin = index == 0 ? 0 : ends_[index - 1];
+    return {row_.data() + begin, ends_[index] - begin};
+}
+
+bool outfit::utils::csv::CsvReader::HasError() const {
+    return error_;
+}
+
+bool outfit::utils::csv::CsvReader::Next(char* c) {
+    if (position_ == size_) {
+        qint64 read = device_->read(buffer_.data(), static_cast<qint64>(buffer_.size()));
+        if (read <= 0) {
+            // A failed read must not pass for the end of a shorter file.
+            error_ = error_ || read < 0;
+            return false;
+        }
+        position_ = 0;
+        size_ = read;
+    }
+    *c = buffer_[position_++];
+    return true;
+}
+
+outfit::utils::csv::CsvWriter::CsvWriter(QIODevice* device, qsizetype flush_size)
+    : device_(device), encoder_(QStringEncoder::Utf8), flush_size_(flush_size) {
+    buffer_.reserve(flush_size_ + flush_size_ / 4);
+}
+
+outfit::utils::csv::CsvWriter::~CsvWriter() {
+    Flush();
+}
+
+void outfit::utils::csv::CsvWriter::WriteField(QStringView field) {
+    BeginField();
+    qsizetype begin = buffer_.size();
+    buffer_.resize(begin + encoder_.requiredSpace(field.size()));
+    char* end = encoder_.appendToBuffer(buffer_.data() + begin, field);
+    buffer_.truncate(end - buffer_.constData());
+    Escape(begin);
+}
+
+void outfit::utils::csv::CsvWriter::WriteField(QByteArrayView field) {
+    BeginField();
+    qsizetype begin = buffer_.size();
+    buffer_.append(field);
+    Escape(begin);
+}
+
+void outfit::utils::csv::CsvWriter::WriteInteger(qint64 value) {
+    BeginField();
+    AppendNumber(value);
+}
+
+void outfit::utils::csv::CsvWriter::WriteUnsigned(quint64 value) {
+    BeginField();
+    AppendNumber(value);
+}
+
+void outfit::utils::csv::CsvWriter::WriteReal(double value) {
+    BeginField();
+    AppendNumber(value);
+}
+
+void outfit::utils::csv::CsvWriter::WriteRaw(QStringView text) {
+    qsizetype begin = buffer_.size();
+    buffer_.resize(begin + encoder_.requiredSpace(text.size()));
+    char* end = encoder_.appendToBuffer(buffer_.data() + begin, text);
+    buffer_.truncate(end - buffer_.constData());
+    row_started_ = true;
+}
+
+void outfit::utils::csv::CsvWriter::EndRow() {
+    buffer_.append('\n');
+    row_started_ = false;
+    if (buffer_.size() >= flush_size_) {
+        Flush();
+    }
+}
+
+bool outfit::utils::csv::CsvWriter::Flush() {
+    if (!buffer_.isEmpty()) {
+        if (write_time_ == nullptr) {
+            error_ = !WriteBuffer() || error_;
+        } else {
+            const Clock::time_point start = Clock::now();
+            error_ = !WriteBuffer() || error_;
+            *write_time_ += Since(start);
+        }
+        // Keeps the allocation for the next chunk.
+        buffer_.resize(0);
+    }
+    return !error_;
+}
+
+bool outfit::utils::csv::CsvWriter::WriteBuffer() {
+    if (device_->write(buffer_.constData(), buffer_.size()) != buffer_.size()) {
+        return false;
+    }
+    bytes_written_ += buffer_.size();
+    return true;
+}
+
+qint64 outfit::utils::csv::CsvWriter::BytesWritten() const {
+    return bytes_written_;
+}
+
+void outfit::utils::csv::CsvWriter::TimeEscaping(std::chrono::nanoseconds* total) {
+    escape_time_ = total;
+}
+
+void outfit::utils::csv::CsvWriter::TimeWrites(std::chrono::nanoseconds* total) {
+    write_time_ = total;
+}
+
+bool outfit::utils::csv::CsvWriter::HasError() const {
+    return error_;
+}
+
+void outfit::utils::csv::CsvWriter::BeginField() {
+    if (row_started_) {
+        buffer_.append(',');
+    }
+    row_started_ = true;
+}
+
+void outfit::utils::csv::CsvWriter::Escape(qsizetype begin) {
+    if (escape_time_ == nullptr) {
+        QuoteFrom(begin);
+        return;
+    }
+    const Clock::time_point start = Clock::now();
+    QuoteFrom(begin);
+    *escape_time_ += Since(start);
+}
+
+void outfit::utils::csv::CsvWriter::QuoteFrom(qsizetype begin) {
+    const char* field = buffer_.constData() + begin;
+    const char* end = buffer_.constData() + buffer_.size();
+    if (FindSpecial(field, end) == end) {
+        return;
+    }
+    // Rebuilds the field from a copy, moving the runs between quotes in bulk.
+    scratch_.resize(0);
+    scratch_.append(field, end - field);
+    buffer_.truncate(begin);
+    buffer_.append('"');
+    const char* run = scratch_.constData();
+    const char* last = run + scratch_.size();
+    while (const auto* quote = static_cast<const char*>(std::memchr(run, '"', last - run))) {
+        buffer_.append(run, quote - run + 1);
+        buffer_.append('"');
+        run = quote + 1;
+    }
+    buffer_.append(run, last - run);
+    buffer_.append('"');
+}
@@ -0,0 +1,176 @@
+#ifndef CREATIVE_CSV_EXPORT_H
+#define CREATIVE_CSV_EXPORT_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringEncoder>
+#include <QStringView>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+class QSqlQuery;
+QT_END_NAMESPACE
+
+// CSV reading and writing without any widgets dependency, usable from batch jobs and benchmarks.
+namespace outfit::utils::csv {
+// Quotes the field when it contains a comma, quote or line break, doubling any quotes inside.
+// Fields that need no quoting are returned without copying.
+QString EscapeCSV(const QString& unexc);
+
+enum class ExportStatus { Ok, Canceled, ConnectionFailed, QueryFailed, WriteFailed };
+
+struct ExportResult {
+    ExportStatus status = ExportStatus::Ok;
+    qint64 rows = 0;
+    // Driver or device message for failed exports.
+    QString error;
+
+    [[nodiscard]] bool IsOk() const {
+        return status == ExportStatus::Ok;
+    }
+};
+
+// Where an export spent its time. Fetch is the time inside query.next(), format the time turning
+// values into text, escape the time spent classifying and quoting fields, and write the time
+// handing full chunks to the device. The first three are sampled on one row in
+// kStatsSampleInterval and scaled up; writes and the totals are measured in full. CPU time is
+// the whole process's.
+struct ExportStats {
+    static constexpr qint64 kStatsSampleInterval = 64;
+
+    qint64 rows = 0;
+    qint64 bytes = 0;
+    std::chrono::nanoseconds fetch{0};
+    std::chrono::nanoseconds format{0};
+    std::chrono::nanoseconds escape{0};
+    std::chrono::nanoseconds write{0};
+    std::chrono::nanoseconds wall{0};
+    std::chrono::microseconds cpu{0};
+
+    // One JSON object with millisecond timings and row and byte rates.
+    [[nodiscard]] QByteArray ToJson() const;
+};
+
+struct ExportOptions {
+    // Polled every few rows; a set flag stops the export with ExportStatus::Canceled.
+    const std::atomic<bool>* cancel = nullptr;
+    // Called with the number of rows fetched so far, on the calling thread.
+    std::function<void(qint64 rows)> on_progress;
+    // Switches the query to a forward-only cursor and formats rows on a second thread while the
+    // calling thread keeps fetching. At most a few batches of rows are in flight, so memory stays
+    // flat however large the result is. The device is written from the formatting thread.
+    bool streaming = false;
+    // Gzips the output on a separate thread (see GzipDevice) before it reaches the device.
+    bool gzip = false;
+    // Enables timing; called once when the export ends, on the calling thread. Byte counts are
+    // of the CSV text, before any compression.
+    std::function<void(const ExportStats& stats)> on_stats;
+};
+
+// Executes the prepared query and writes the header line followed by one CSV row per result row.
+// An empty header writes no header line.
+ExportResult ExportQuery(
+    QSqlQuery& query, QIODevice* device, const QString& header, const ExportOptions& options = {});
+// Same, writing to an already open file descriptor, which is left open.
+ExportResult ExportQuery(
+    QSqlQuery& query, int fd, const QString& header, const ExportOptions& options = {});
+
+// Streaming RFC 4180 reader over UTF-8 input. Memory use is bounded by the read buffer plus the
+// longest record; fields are unescaped in place and handed out as views that stay valid until
+// the next ReadRow call.
+class CsvReader {
+   public:
+    static constexpr qsizetype kDefaultBufferSize = 64 * 1024;
+
+    explicit CsvReader(QIODevice* device, qsizetype buffer_size = kDefaultBufferSize);
+
+    // Returns false once the input is exhausted.
+    bool ReadRow();
+    [[nodiscard]] qsizetype FieldCount() const;
+    [[nodiscard]] QByteArrayView Field(qsizetype index) const;
+    // Set when the input ended inside a quoted field or the device failed to read.
+    [[nodiscard]] bool HasError() const;
+
+   private:
+    bool Next(char* c);
+
+    QIODevice* device_;
+    std::vector<char> buffer_;
+    qsizetype position_ = 0;
+    qsizetype size_ = 0;
+    std::string row_;
+    std::vector<qsizetype> ends_;
+    bool skip_line_feed_ = false;
+    bool error_ = false;
+};
+
+// Buffered RFC 4180 writer producing UTF-8. Fields are encoded straight into one reusable byte
+// buffer, classified with FindSpecial and quoted only when they contain a separator, quote or
+// line break; the buffer is handed to the device in chunks of about flush_size bytes.
+class CsvWriter {
+   public:
+    static constexpr qsizetype kDefaultFlushSize = 1024 * 1024;
+
+    explicit CsvWriter(QIODevice* device, qsizetype flush_size = kDefaultFlushSize);
+    ~CsvWriter();
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    void WriteField(QStringView field);
+    // The field is already UTF-8 encoded.
+    void WriteField(QByteArrayView field);
+    // Numbers are formatted locale-free with std::to_chars, straight into the buffer; doubles use
+    // the shortest representation that reads back exactly.
+    void WriteInteger(qint64 value);
+    void WriteUnsigned(quint64 value);
+    void WriteReal(double value);
+    // Appends text as is, without a separator or quoting.
+    void WriteRaw(QStringView text);
+    void EndRow();
+    // Writes out everything buffered so far; returns false if the device rejected any of it.
+    bool Flush();
+    [[nodiscard]] bool HasError() const;
+    [[nodiscard]] qint64 BytesWritten() const;
+    // While set, the time spent quoting fields or writing to the device is added to `total`.
+    void TimeEscaping(std::chrono::nanoseconds* total);
+    void TimeWrites(std::chrono::nanoseconds* total);
+
+   private:
+    // Longest std::to_chars output for the types above.
+    static constexpr qsizetype kMaxNumberLength = 32;
+
+    void BeginField();
+    void Escape(qsizetype begin);
+    void QuoteFrom(qsizetype begin);
+    bool WriteBuffer();
+    template <class T>
+    void AppendNumber(T value) {
+        qsizetype begin = buffer_.size();
+        buffer_.resize(begin + kMaxNumberLength);
+        char* data = buffer_.data();
+        char* end = std::to_chars(data + begin, data + begin + kMaxNumberLength, value).ptr;
+        buffer_.truncate(end - data);
+    }
+
+    QIODevice* device_;
+    QByteArray buffer_;
+    QByteArray scratch_;
+    QStringEncoder encoder_;
+    qsizetype flush_size_;
+    qint64 bytes_written_ = 0;
+    std::chrono::nanoseconds* escape_time_ = nullptr;
+    std::chrono::nanoseconds* write_time_ = nullptr;
+    bool row_started_ = false;
+    bool error_ = false;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_EXPORT_H
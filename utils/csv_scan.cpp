@@ -0,0 +1,121 @@
+#include "csv_scan.h"
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CSV_SCAN_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CSV_SCAN_NEON
+#endif
+
+namespace {
+
+template <class Char>
+bool IsSpecial(Char c) {
+    return c == ',' || c == '"' || c == '\r' || c == '\n';
+}
+
+template <class Char>
+const Char* FindSpecialScalar(const Char* begin, const Char* end) {
+    while (begin != end && !IsSpecial(*begin)) {
+        ++begin;
+    }
+    return begin;
+}
+
+int CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+#ifdef CSV_SCAN_NEON
+int CountTrailingZeros64(uint64_t mask) {
+    return __builtin_ctzll(mask);
+}
+#endif
+
+}  // namespace
+
+const char* outfit::utils::csv::FindSpecial(const char* begin, const char* end) {
+#if defined(CSV_SCAN_SSE2)
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    for (; end - begin >= 16; begin += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, quote)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+        if (mask != 0) {
+            return begin + CountTrailingZeros(mask);
+        }
+    }
+#elif defined(CSV_SCAN_NEON)
+    const uint8x16_t comma = vdupq_n_u8(',');
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    for (; end - begin >= 16; begin += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(begin));
+        uint8x16_t hits = vorrq_u8(
+            vorrq_u8(vceqq_u8(chunk, comma), vceqq_u8(chunk, quote)),
+            vorrq_u8(vceqq_u8(chunk, cr), vceqq_u8(chunk, lf)));
+        // Narrows every byte of the comparison to four bits of a 64-bit mask.
+        uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+        if (mask != 0) {
+            return begin + CountTrailingZeros64(mask) / 4;
+        }
+    }
+#endif
+    return FindSpecialScalar(begin, end);
+}
+
+const char16_t* outfit::utils::csv::FindSpecial(const char16_t* begin, const char16_t* end) {
+#if defined(CSV_SCAN_SSE2)
+    const __m128i comma = _mm_set1_epi16(',');
+    const __m128i quote = _mm_set1_epi16('"');
+    const __m128i cr = _mm_set1_epi16('\r');
+    const __m128i lf = _mm_set1_epi16('\n');
+    for (; end - begin >= 8; begin += 8) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi16(chunk, comma), _mm_cmpeq_epi16(chunk, quote)),
+            _mm_or_si128(_mm_cmpeq_epi16(chunk, cr), _mm_cmpeq_epi16(chunk, lf)));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+        if (mask != 0) {
+            return begin + CountTrailingZeros(mask) / 2;
+        }
+    }
+#elif defined(CSV_SCAN_NEON)
+    const uint16x8_t comma = vdupq_n_u16(',');
+    const uint16x8_t quote = vdupq_n_u16('"');
+    const uint16x8_t cr = vdupq_n_u16('\r');
+    const uint16x8_t lf = vdupq_n_u16('\n');
+    for (; end - begin >= 8; begin += 8) {
+        uint16x8_t chunk = vld1q_u16(reinterpret_cast<const uint16_t*>(begin));
+        uint16x8_t hits = vorrq_u16(
+            vorrq_u16(vceqq_u16(chunk, comma), vceqq_u16(chunk, quote)),
+            vorrq_u16(vceqq_u16(chunk, cr), vceqq_u16(chunk, lf)));
+        // Narrows every element of the comparison to eight bits of a 64-bit mask.
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(hits)), 0);
+        if (mask != 0) {
+            return begin + CountTrailingZeros64(mask) / 8;
+        }
+    }
+#endif
+    return FindSpecialScalar(begin, end);
+}
@@ -0,0 +1,12 @@
+#ifndef CREATIVE_CSV_SCAN_H
+#define CREATIVE_CSV_SCAN_H
+
+namespace outfit::utils::csv {
+// Returns the first character in [begin, end) that forces a CSV field to be quoted (a comma,
+// quote, carriage return or line feed), or end when the field can be written as is. Inputs are
+// classified 16 bytes at a time with SSE2 or NEON where available.
+const char* FindSpecial(const char* begin, const char* end);
+const char16_t* FindSpecial(const char16_t* begin, const char16_t* end);
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_CSV_SCAN_H
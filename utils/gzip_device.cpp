@@ -0,0 +1,113 @@
+#include "gzip_device.h"
+
+#include <utility>
+#include <zlib.h>
+
+namespace {
+
+// Chunks waiting for the compressor; with 1 MiB writer flushes this bounds the backlog to a few
+// megabytes.
+constexpr size_t kQueueDepth = 4;
+constexpr qsizetype kOutputSize = 256 * 1024;
+// Window bits for deflate with a gzip header and trailer instead of a raw zlib stream.
+constexpr int kGzipWindowBits = 15 + 16;
+constexpr int kMemoryLevel = 8;
+
+}  // namespace
+
+outfit::utils::csv::GzipDevice::GzipDevice(QIODevice* target, int level, QObject* parent)
+    : QIODevice(parent)
+    , target_(target)
+    , level_(level)
+    , stream_(std::make_unique<z_stream_s>())
+    , chunks_(kQueueDepth) {
+}
+
+outfit::utils::csv::GzipDevice::~GzipDevice() {
+    if (isOpen()) {
+        close();
+    }
+}
+
+bool outfit::utils::csv::GzipDevice::open(OpenMode mode) {
+    if ((mode & ReadOnly) != 0 || (mode & WriteOnly) == 0) {
+        setErrorString("gzip device is write-only");
+        return false;
+    }
+    *stream_ = z_stream_s{};
+    const int status = deflateInit2(
+        stream_.get(), level_, Z_DEFLATED, kGzipWindowBits, kMemoryLevel, Z_DEFAULT_STRATEGY);
+    if (status != Z_OK) {
+        setErrorString("failed to initialize deflate");
+        return false;
+    }
+    output_.resize(kOutputSize);
+    error_ = false;
+    compressor_ = std::thread([this] { Compress(); });
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void outfit::utils::csv::GzipDevice::close() {
+    if (!isOpen()) {
+        return;
+    }
+    chunks_.Close();
+    compressor_.join();
+    if (error_) {
+        setErrorString(target_->errorString());
+    }
+    QIODevice::close();
+}
+
+bool outfit::utils::csv::GzipDevice::isSequential() const {
+    return true;
+}
+
+bool outfit::utils::csv::GzipDevice::HasError() const {
+    return error_;
+}
+
+qint64 outfit::utils::csv::GzipDevice::readData(char*, qint64) {
+    return -1;
+}
+
+qint64 outfit::utils::csv::GzipDevice::writeData(const char* data, qint64 size) {
+    if (error_ || !chunks_.Push(QByteArray(data, size))) {
+        return -1;
+    }
+    return size;
+}
+
+void outfit::utils::csv::GzipDevice::Compress() {
+    while (std::optional<QByteArray> chunk = chunks_.Pop()) {
+        if (error_) {
+            continue;
+        }
+        stream_->next_in = reinterpret_cast<Bytef*>(chunk->data());
+        stream_->avail_in = static_cast<uInt>(chunk->size());
+        if (!Deflate(Z_NO_FLUSH)) {
+            error_ = true;
+        }
+    }
+    if (!error_ && !Deflate(Z_FINISH)) {
+        error_ = true;
+    }
+    deflateEnd(stream_.get());
+}
+
+bool outfit::utils::csv::GzipDevice::Deflate(int flush) {
+    int status = Z_OK;
+    do {
+        stream_->next_out = reinterpret_cast<Bytef*>(output_.data());
+        stream_->avail_out = static_cast<uInt>(output_.size());
+        status = deflate(stream_.get(), flush);
+        if (status == Z_STREAM_ERROR) {
+            return false;
+        }
+        qint64 produced = output_.size() - static_cast<qint64>(stream_->avail_out);
+        if (produced > 0 && target_->write(output_.constData(), produced) != produced) {
+            return false;
+        }
+    } while (stream_->avail_out == 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+    return true;
+}
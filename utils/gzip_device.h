@@ -0,0 +1,51 @@
+#ifndef CREATIVE_GZIP_DEVICE_H
+#define CREATIVE_GZIP_DEVICE_H
+
+#include "bounded_queue.h"
+
+#include <QByteArray>
+#include <QIODevice>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+struct z_stream_s;
+
+namespace outfit::utils::csv {
+// Write-only device that gzips everything written to it into another device. Compression runs on
+// its own thread: writes only copy the data into a short queue, so formatting and deflating
+// overlap. close() drains the queue and writes the gzip trailer; the device can be opened once.
+class GzipDevice : public QIODevice {  // NOLINT
+    Q_OBJECT
+
+   public:
+    static constexpr int kDefaultLevel = 6;
+
+    explicit GzipDevice(QIODevice* target, int level = kDefaultLevel, QObject* parent = nullptr);
+    ~GzipDevice() override;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    [[nodiscard]] bool isSequential() const override;
+    // Set when deflate or the target device failed; later writes are rejected.
+    [[nodiscard]] bool HasError() const;
+
+   protected:
+    qint64 readData(char* data, qint64 max_size) override;
+    qint64 writeData(const char* data, qint64 size) override;
+
+   private:
+    void Compress();
+    bool Deflate(int flush);
+
+    QIODevice* target_;
+    int level_;
+    std::unique_ptr<z_stream_s> stream_;
+    QByteArray output_;
+    BoundedQueue<QByteArray> chunks_;
+    std::thread compressor_;
+    std::atomic<bool> error_ = false;
+};
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_GZIP_DEVICE_H
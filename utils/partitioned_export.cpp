@@ -0,0 +1,354 @@
+#include "partitioned_export.h"
+
+#include "gzip_device.h"
+#include "tools/util/util.h"
+
+#include <QDir>
+#include <QIODevice>
+#include <QMetaType>
+#include <QSaveFile>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QUuid>
+#include <QVariant>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using outfit::utils::csv::ExportOptions;
+using outfit::utils::csv::ExportResult;
+using outfit::utils::csv::ExportStats;
+using outfit::utils::csv::ExportStatus;
+using outfit::utils::csv::PartitionedQuery;
+
+constexpr auto kProgressInterval = std::chrono::milliseconds(250);
+
+struct KeyRange {
+    qint64 low = 0;
+    qint64 high = 0;
+    // The last slice includes the maximum key itself.
+    bool last = false;
+    // Selects the rows whose key is NULL instead of a key range.
+    bool nulls = false;
+};
+
+// Cuts [min_key, max_key] into at most `count` non-empty slices of nearly equal width.
+std::vector<KeyRange> SplitKeys(qint64 min_key, qint64 max_key, int count) {
+    const quint64 span = static_cast<quint64>(max_key) - static_cast<quint64>(min_key);
+    const auto parts = static_cast<quint64>(count) > span ? span + 1 : static_cast<quint64>(count);
+    std::vector<KeyRange> ranges;
+    ranges.reserve(parts);
+    auto bound = [&](quint64 i) {
+        return static_cast<qint64>(
+            static_cast<quint64>(min_key) + span / parts * i + span % parts * i / parts);
+    };
+    for (quint64 i = 0; i < parts; ++i) {
+        ranges.push_back({bound(i), i + 1 == parts ? max_key : bound(i + 1), i + 1 == parts});
+    }
+    return ranges;
+}
+
+QString SliceSql(
+    const PartitionedQuery& source, const QSqlDriver* driver, const KeyRange& range) {
+    const QString table = driver->escapeIdentifier(source.table, QSqlDriver::TableName);
+    const QString key = driver->escapeIdentifier(source.key_column, QSqlDriver::FieldName);
+    if (range.nulls) {
+        return QString("SELECT %1 FROM %2 WHERE %3 IS NULL").arg(source.columns, table, key);
+    }
+    return QString("SELECT %1 FROM %2 WHERE %3 >= ? AND %3 %4 ? ORDER BY %3")
+        .arg(source.columns, table, key, range.last ? "<=" : "<");
+}
+
+// Exports one slice through a private connection; runs on the partition's own thread.
+ExportResult ExportSlice(
+    const PartitionedQuery& source, const KeyRange& range, QIODevice* device, const QString& header,
+    const ExportOptions& options) {
+    const QString clone_name =
+        "csv-partition-" + QUuid::createUuid().toString(QUuid::WithoutBraces);
+    ExportResult result;
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(source.connection_name, clone_name);
+        if (!db.open()) {
+            result = {ExportStatus::ConnectionFailed, 0, db.lastError().text()};
+        } else {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            query.prepare(SliceSql(source, db.driver(), range));
+            if (!range.nulls) {
+                query.addBindValue(range.low);
+                query.addBindValue(range.high);
+            }
+            result = outfit::utils::csv::ExportQuery(query, device, header, options);
+        }
+    }
+    QSqlDatabase::removeDatabase(clone_name);
+    return result;
+}
+
+// Runs `run(i)` for every slice on its own thread. The calling thread forwards the combined row
+// count to the progress callback until all of them are done; the first failure wins. With
+// on_stats set, the phase timings and byte counts of the slices are added to `stats`.
+ExportResult RunSlices(
+    size_t count, const ExportOptions& options, ExportStats* stats,
+    const std::function<ExportResult(size_t, const ExportOptions&)>& run) {
+    std::vector<ExportResult> results(count);
+    std::vector<ExportStats> slice_stats(count);
+    std::vector<std::unique_ptr<std::atomic<qint64>>> rows(count);
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t running = count;
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        rows[i] = std::make_unique<std::atomic<qint64>>(0);
+        threads.emplace_back([&, i] {
+            ExportOptions slice_options;
+            slice_options.cancel = options.cancel;
+            slice_options.gzip = options.gzip;
+            slice_options.on_progress = [&rows, i](qint64 slice_rows) {
+                rows[i]->store(slice_rows, std::memory_order_relaxed);
+            };
+            if (options.on_stats) {
+                slice_options.on_stats = [&slice_stats, i](const ExportStats& slice) {
+                    slice_stats[i] = slice;
+                };
+            }
+            results[i] = run(i, slice_options);
+            std::lock_guard lock(mutex);
+            --running;
+            done.notify_one();
+        });
+    }
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            if (done.wait_for(lock, kProgressInterval, [&] { return running == 0; })) {
+                break;
+            }
+        }
+        if (options.on_progress) {
+            qint64 total = 0;
+            for (const auto& slice_rows : rows) {
+                total += slice_rows->load(std::memory_order_relaxed);
+            }
+            options.on_progress(total);
+        }
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const ExportStats& slice : slice_stats) {
+        stats->rows += slice.rows;
+        stats->bytes += slice.bytes;
+        stats->fetch += slice.fetch;
+        stats->format += slice.format;
+        stats->escape += slice.escape;
+        stats->write += slice.write;
+    }
+    ExportResult combined;
+    for (const ExportResult& result : results) {
+        combined.rows += result.rows;
+        if (combined.IsOk() && !result.IsOk()) {
+            combined.status = result.status;
+            combined.error = result.error;
+        }
+    }
+    return combined;
+}
+
+int PartitionCount(const PartitionedQuery& source) {
+    return source.partitions > 0 ? source.partitions : QThread::idealThreadCount();
+}
+
+// Whether the driver returned the value as an integer rather than a real, text or blob.
+bool IsInteger(const QVariant& value) {
+    switch (value.metaType().id()) {
+        case QMetaType::Char:
+        case QMetaType::SChar:
+        case QMetaType::UChar:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::Long:
+        case QMetaType::ULong:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Looks up the key bounds on the caller's connection and cuts them into slices, followed by one
+// slice for the rows whose key is NULL. An empty table gives no slices. A key whose bounds do not
+// come back as integers is rejected rather than truncated by toLongLong.
+std::vector<KeyRange> PlanSlices(const PartitionedQuery& source, ExportResult* result) {
+    QSqlDatabase db = QSqlDatabase::database(source.connection_name);
+    const QSqlDriver* driver = db.driver();
+    const QString key = driver->escapeIdentifier(source.key_column, QSqlDriver::FieldName);
+    const QString table = driver->escapeIdentifier(source.table, QSqlDriver::TableName);
+    const QString sql = QString("SELECT MIN(%1), MAX(%1), COUNT(*) - COUNT(%1) FROM %2");
+    QSqlQuery query(db);
+    if (!query.exec(sql.arg(key, table)) || !query.next()) {
+        *result = {ExportStatus::QueryFailed, 0, query.lastError().text()};
+        return {};
+    }
+    std::vector<KeyRange> ranges;
+    const QVariant min_key = query.value(0);
+    const QVariant max_key = query.value(1);
+    if (!min_key.isNull()) {
+        if (!IsInteger(min_key) || !IsInteger(max_key)) {
+            *result = {
+                ExportStatus::QueryFailed, 0,
+                QString("partition key %1 is not an integer column").arg(source.key_column)};
+            return {};
+        }
+        ranges = SplitKeys(min_key.toLongLong(), max_key.toLongLong(), PartitionCount(source));
+    }
+    if (query.value(2).toLongLong() > 0) {
+        ranges.push_back({.nulls = true});
+    }
+    return ranges;
+}
+
+// Writes only the header, for a table without rows. With gzip the output is still a gzip member,
+// even when the header is empty, so it decompresses like any other export.
+ExportResult WriteHeader(QIODevice* device, const QString& header, bool gzip) {
+    if (gzip) {
+        outfit::utils::csv::GzipDevice compressed(device);
+        if (!compressed.open(QIODevice::WriteOnly)) {
+            return {ExportStatus::WriteFailed, 0, compressed.errorString()};
+        }
+        ExportResult result = WriteHeader(&compressed, header, false);
+        compressed.close();
+        if (result.IsOk() && compressed.HasError()) {
+            result = {ExportStatus::WriteFailed, 0, compressed.errorString()};
+        }
+        return result;
+    }
+    if (!header.isEmpty()) {
+        outfit::utils::csv::CsvWriter writer(device);
+        writer.WriteRaw(header);
+        writer.EndRow();
+        if (!writer.Flush()) {
+            return {ExportStatus::WriteFailed, 0, device->errorString()};
+        }
+    }
+    return {};
+}
+
+// Hands the merged slice stats to the sink, with the wall and CPU time of the whole export.
+void Report(const ExportOptions& options, ExportStats* stats, const Timer& total) {
+    if (!options.on_stats) {
+        return;
+    }
+    const auto times = total.GetTimes();
+    stats->wall = std::chrono::duration_cast<std::chrono::nanoseconds>(times.wall_time);
+    stats->cpu = times.cpu_time;
+    options.on_stats(*stats);
+}
+
+bool AppendFile(QIODevice* from, QIODevice* to) {
+    std::vector<char> chunk(outfit::utils::csv::CsvWriter::kDefaultFlushSize);
+    if (!from->seek(0)) {
+        return false;
+    }
+    while (true) {
+        qint64 read = from->read(chunk.data(), static_cast<qint64>(chunk.size()));
+        if (read < 0) {
+            return false;
+        }
+        if (read == 0) {
+            return true;
+        }
+        if (to->write(chunk.data(), read) != read) {
+            return false;
+        }
+    }
+}
+
+}  // namespace
+
+outfit::utils::csv::ExportResult outfit::utils::csv::ExportPartitioned(
+    const PartitionedQuery& source, QIODevice* device, const QString& header,
+    const ExportOptions& options) {
+    const Timer total;
+    ExportStats stats;
+    ExportResult result;
+    const std::vector<KeyRange> ranges = PlanSlices(source, &result);
+    if (!result.IsOk()) {
+        return result;
+    }
+    if (ranges.empty()) {
+        result = WriteHeader(device, header, options.gzip);
+        stats.bytes = header.isEmpty() ? 0 : header.toUtf8().size() + 1;
+        Report(options, &stats, total);
+        return result;
+    }
+    std::vector<std::unique_ptr<QTemporaryFile>> spools;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        auto spool = std::make_unique<QTemporaryFile>(QDir::tempPath() + "/csv-part-XXXXXX");
+        if (!spool->open()) {
+            return {ExportStatus::WriteFailed, 0, spool->errorString()};
+        }
+        spools.push_back(std::move(spool));
+    }
+    result = RunSlices(
+        ranges.size(), options, &stats, [&](size_t i, const ExportOptions& slice_options) {
+            if (i == 0) {
+                return ExportSlice(source, ranges[i], device, header, slice_options);
+            }
+            return ExportSlice(source, ranges[i], spools[i - 1].get(), QString(), slice_options);
+        });
+    for (size_t i = 0; result.IsOk() && i < spools.size(); ++i) {
+        if (!AppendFile(spools[i].get(), device)) {
+            result.status = ExportStatus::WriteFailed;
+            result.error = device->errorString();
+        }
+    }
+    Report(options, &stats, total);
+    return result;
+}
+
+outfit::utils::csv::ExportResult outfit::utils::csv::ExportPartitionedFiles(
+    const PartitionedQuery& source, const QString& base_name, const QString& header,
+    const ExportOptions& options) {
+    const Timer total;
+    ExportStats stats;
+    ExportResult result;
+    const std::vector<KeyRange> ranges = PlanSlices(source, &result);
+    if (!result.IsOk()) {
+        return result;
+    }
+    if (!ranges.empty()) {
+        result = RunSlices(
+            ranges.size(), options, &stats, [&](size_t i, const ExportOptions& slice_options) {
+                QSaveFile part(
+                    QString("%1.part%2.csv").arg(base_name).arg(i, 3, 10, QLatin1Char('0')));
+                if (!part.open(QIODevice::WriteOnly)) {
+                    return ExportResult{ExportStatus::WriteFailed, 0, part.errorString()};
+                }
+                ExportResult slice = ExportSlice(source, ranges[i], &part, header, slice_options);
+                if (!slice.IsOk()) {
+                    part.cancelWriting();
+                } else if (!part.commit()) {
+                    slice = {ExportStatus::WriteFailed, slice.rows, part.errorString()};
+                }
+                return slice;
+            });
+    }
+    Report(options, &stats, total);
+    return result;
+}
@@ -0,0 +1,44 @@
+#ifndef CREATIVE_PARTITIONED_EXPORT_H
+#define CREATIVE_PARTITIONED_EXPORT_H
+
+#include "csv_export.h"
+
+#include <QString>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+namespace outfit::utils::csv {
+// A table exported in parallel: the range of an integer key column is cut into equal slices, and
+// every slice is queried and formatted on its own thread through its own clone of the connection.
+// Rows whose key is NULL form one more slice; a key column holding anything but integers fails
+// the export with ExportStatus::QueryFailed.
+//
+// on_stats is called once, after the last partition: the phase timings and byte counts are summed
+// over the partitions, so the phases may add up to more than the wall time of the whole export.
+struct PartitionedQuery {
+    QString connection_name;
+    QString table;
+    QString key_column;
+    // Select list, written into the query as is.
+    QString columns = "*";
+    // Zero picks one partition per hardware thread.
+    int partitions = 0;
+};
+
+// Writes the header and then every partition in key order, NULL keys last, as a single CSV
+// stream. The first partition goes to the device directly; the others are spooled to temporary
+// files and appended once they are done, so memory use does not depend on the table size. With
+// gzip every partition becomes its own gzip member, and the concatenation is still a valid gzip
+// file.
+ExportResult ExportPartitioned(
+    const PartitionedQuery& source, QIODevice* device, const QString& header,
+    const ExportOptions& options = {});
+// Writes every partition with its own header to base_name.partNNN.csv, skipping the final copy.
+ExportResult ExportPartitionedFiles(
+    const PartitionedQuery& source, const QString& base_name, const QString& header,
+    const ExportOptions& options = {});
+}  // namespace outfit::utils::csv
+
+#endif  // CREATIVE_PARTITIONED_EXPORT_H
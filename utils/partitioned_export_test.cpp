@@ -0,0 +1,105 @@
+#include "partitioned_export.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QTemporaryDir>
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <optional>
+#include <zlib.h>
+
+namespace {
+
+constexpr char kConnection[] = "partitioned-export-test";
+// Window bits that make inflate expect a gzip header and trailer.
+constexpr int kGzipWindowBits = 15 + 16;
+
+// Inflates every gzip member of `compressed`; nullopt unless the whole input is valid gzip.
+std::optional<QByteArray> Gunzip(const QByteArray& compressed) {
+    z_stream stream{};
+    if (inflateInit2(&stream, kGzipWindowBits) != Z_OK) {
+        return std::nullopt;
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.constData()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    QByteArray plain;
+    char chunk[4096];
+    while (true) {
+        stream.next_out = reinterpret_cast<Bytef*>(chunk);
+        stream.avail_out = sizeof(chunk);
+        const int status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END) {
+            inflateEnd(&stream);
+            return std::nullopt;
+        }
+        plain.append(chunk, static_cast<qsizetype>(sizeof(chunk) - stream.avail_out));
+        if (status == Z_STREAM_END) {
+            if (stream.avail_in == 0) {
+                break;
+            }
+            inflateReset(&stream);
+        }
+    }
+    inflateEnd(&stream);
+    return plain;
+}
+
+// An empty table in a file database, so that the export's cloned connections see it too.
+class EmptyTable {
+   public:
+    EmptyTable() {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+        db.setDatabaseName(dir_.filePath("items.sqlite"));
+        REQUIRE(db.open());
+        REQUIRE(QSqlQuery(db).exec("CREATE TABLE items (id INTEGER, name TEXT)"));
+    }
+
+    ~EmptyTable() {
+        QSqlDatabase::database(kConnection).close();
+        QSqlDatabase::removeDatabase(kConnection);
+    }
+
+    EmptyTable(const EmptyTable&) = delete;
+    EmptyTable& operator=(const EmptyTable&) = delete;
+
+    [[nodiscard]] static outfit::utils::csv::PartitionedQuery Query() {
+        return {.connection_name = kConnection, .table = "items", .key_column = "id"};
+    }
+
+   private:
+    QTemporaryDir dir_;
+};
+
+QByteArray Export(const QString& header, bool gzip) {
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    outfit::utils::csv::ExportOptions options;
+    options.gzip = gzip;
+    const outfit::utils::csv::ExportResult result =
+        outfit::utils::csv::ExportPartitioned(EmptyTable::Query(), &buffer, header, options);
+    REQUIRE(result.IsOk());
+    CHECK(result.rows == 0);
+    return buffer.data();
+}
+
+}  // namespace
+
+TEST_CASE("Empty table writes only the header") {
+    const EmptyTable table;
+    CHECK(Export("id,name", false) == "id,name\n");
+}
+
+TEST_CASE("Empty table with gzip is still a gzip stream") {
+    const EmptyTable table;
+    CHECK(Gunzip(Export("id,name", true)) == QByteArray("id,name\n"));
+    CHECK(Gunzip(Export(QString(), true)) == QByteArray());
+}
+
+int main(int argc, char* argv[]) {
+    // The SQLite driver is a plugin, which needs an application object to be found.
+    QCoreApplication app(argc, argv);
+    return Catch::Session().run(argc, argv);
+}